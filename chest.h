@@ -22,6 +22,13 @@
  * PASSED)
  * CHEST_DONE_FAIL        Text printed for failed tests in summary (default:
  * FAILED)
+ * CHEST_CRASH_STR        Text printed on test crash (default: "CRASH")
+ * CHEST_DONE_CRASH       Text printed for crashed tests in summary (default:
+ * CRASHED)
+ * CHEST_DONE_SKIP        Text printed for tests skipped by --fail-fast
+ * (default: SKIPPED)
+ * CHEST_DONE_UNREGISTERED Text printed for failed registrations (default:
+ * NOT REGISTERED)
  *
  * CHEST_SEPARATOR        Separator used between results and summary (default:
  * "---")
@@ -36,9 +43,30 @@
  * CHEST_MEASURE_COLOR    ANSI for timing (default: "\x1b[90m")
  * CHEST_RESET_COLOR      ANSI reset (default: "\x1b[0m")
  *
+ * CHEST_SHARED           Emit declarations only; link one TU that defines
+ * CHEST_IMPLEMENTATION   (with CHEST_SHARED) to hold the runner, registry and
+ *                        formatting code once. All TUs must agree on every
+ *                        other configuration macro.
+ *
  * CHEST_MALLOC           Allocator macro (default: malloc)
  * CHEST_REALLOC          Reallocator macro (default: realloc)
  * CHEST_FREE             Deallocator macro (default: free)
+ *
+ * CHEST_SNAPSHOT_CONTEXT   Unchanged lines shown around text diff hunks
+ * (default: 3)
+ * CHEST_SNAPSHOT_MAX_EDITS Line edit budget for the text diff (default: 512)
+ * CHEST_SNAPSHOT_MAX_LINES Diff lines printed per mismatch (default: 40)
+ * CHEST_SNAPSHOT_HEX_ROWS  16-byte rows shown in binary diffs (default: 4)
+ * CHEST_SNAPSHOT_ENV       Env var enabling golden updates (default:
+ * "CHEST_UPDATE_SNAPSHOTS")
+ *
+ * CHEST_RING_SLOTS       Result records in the isolation ring (default: 64)
+ * CHEST_STRESS_MAX_MSGS  Stress failure messages kept per thread (default: 8)
+ * CHEST_STRESS_MSG_SIZE  Bytes per stress failure message (default: 256)
+ * CHEST_RECORD_MSG_SIZE  Failure message bytes per record (default: 1024);
+ *                        longer messages end in "[truncated]"
+ * CHEST_REPEAT_SAMPLES   Timings kept per test for the repeat median; older
+ *                        runs are overwritten (default: 4096)
  */
 
 #ifndef CHEST_H_
@@ -48,8 +76,12 @@
 extern "C" {
 #endif
 
+#include <errno.h>
 #include <limits.h>
 #include <math.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -58,6 +90,12 @@ extern "C" {
 #include <string.h>
 #include <time.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define CHEST_HAS_POSIX 1
+#else
+#define CHEST_HAS_POSIX 0
+#endif
+
 #ifndef CHEST_DESC_LT
 #define CHEST_DESC_LT "LESS THAN"
 #endif
@@ -112,6 +150,19 @@ extern "C" {
 #define CHEST_DONE_FAIL "FAILED"
 #endif
 
+#ifndef CHEST_CRASH_STR
+#define CHEST_CRASH_STR "CRASH"
+#endif
+#ifndef CHEST_DONE_CRASH
+#define CHEST_DONE_CRASH "CRASHED"
+#endif
+#ifndef CHEST_DONE_SKIP
+#define CHEST_DONE_SKIP "SKIPPED"
+#endif
+#ifndef CHEST_DONE_UNREGISTERED
+#define CHEST_DONE_UNREGISTERED "NOT REGISTERED"
+#endif
+
 #ifndef CHEST_SEPARATOR
 #define CHEST_SEPARATOR "---"
 #endif
@@ -154,6 +205,40 @@ extern "C" {
 #define CHEST_DEFAULT_TERM_WIDTH 80
 #endif
 
+#ifndef CHEST_SNAPSHOT_CONTEXT
+#define CHEST_SNAPSHOT_CONTEXT 3
+#endif
+#ifndef CHEST_SNAPSHOT_MAX_EDITS
+#define CHEST_SNAPSHOT_MAX_EDITS 512
+#endif
+#ifndef CHEST_SNAPSHOT_MAX_LINES
+#define CHEST_SNAPSHOT_MAX_LINES 40
+#endif
+#ifndef CHEST_SNAPSHOT_HEX_ROWS
+#define CHEST_SNAPSHOT_HEX_ROWS 4
+#endif
+#ifndef CHEST_SNAPSHOT_ENV
+#define CHEST_SNAPSHOT_ENV "CHEST_UPDATE_SNAPSHOTS"
+#endif
+
+#ifndef CHEST_RING_SLOTS
+#define CHEST_RING_SLOTS 64
+#endif
+#ifndef CHEST_RECORD_MSG_SIZE
+#define CHEST_RECORD_MSG_SIZE 1024
+#endif
+
+#ifndef CHEST_REPEAT_SAMPLES
+#define CHEST_REPEAT_SAMPLES 4096
+#endif
+
+#ifndef CHEST_STRESS_MAX_MSGS
+#define CHEST_STRESS_MAX_MSGS 8
+#endif
+#ifndef CHEST_STRESS_MSG_SIZE
+#define CHEST_STRESS_MSG_SIZE 256
+#endif
+
 #define LT CHEST_CMP_LT
 #define LE CHEST_CMP_LE
 #define GT CHEST_CMP_GT
@@ -182,20 +267,97 @@ extern "C" {
 #define CHEST_STREQ(ctx, A, B)                                                 \
   chest_streq((ctx), (A), (B), #A " == " #B, __FILE__, __LINE__)
 
+/* fatal variants: a failure ends the running test at once */
+#define CHEST_REQUIRE_COMPARE(ctx, op, A, B)                                   \
+  chest_require((ctx),                                                         \
+                chest_assert_compare((ctx), op, (long double)(A),              \
+                                     (long double)(B),                         \
+                                     #A " " OPSTR_##op " " #B, __FILE__,       \
+                                     __LINE__),                                \
+                __FILE__, __LINE__)
+
+#define CHEST_REQUIRE_EQUAL(ctx, X, Y)                                         \
+  chest_require((ctx),                                                         \
+                chest_memeq((ctx), &(X), &(Y), sizeof(X), #X " == " #Y,        \
+                            __FILE__, __LINE__),                               \
+                __FILE__, __LINE__)
+
+#define CHEST_REQUIRE_FPEQ(ctx, A, B, tol)                                     \
+  chest_require((ctx),                                                         \
+                chest_fpeq((ctx), (long double)(A), (long double)(B),          \
+                           (long double)(tol), #A " ≈ " #B, __FILE__,          \
+                           __LINE__),                                          \
+                __FILE__, __LINE__)
+
+#define CHEST_REQUIRE_STREQ(ctx, A, B)                                         \
+  chest_require((ctx),                                                         \
+                chest_streq((ctx), (A), (B), #A " == " #B, __FILE__,           \
+                            __LINE__),                                         \
+                __FILE__, __LINE__)
+
+#define CHEST_SNAPSHOT(ctx, path, buf, len)                                    \
+  chest_snapshot((ctx), (path), (buf), (len), __FILE__, __LINE__)
+
+/* expected outcomes for CHEST_EXPECT_DEATH */
+#define CHEST_SIGNAL(sig) (-(sig))
+#define CHEST_EXIT(status) (status)
+#define CHEST_ANY_DEATH INT_MIN
+
+#define CHEST_EXPECT_DEATH(ctx, stmt, expect)                                  \
+  do {                                                                         \
+    int chest_status_ = 0;                                                     \
+    int chest_forked_ = chest_death_fork((ctx), &chest_status_);               \
+    if (chest_forked_ == 0) {                                                  \
+      stmt;                                                                    \
+      chest_death_survived(ctx);                                               \
+    }                                                                          \
+    chest_death_check((ctx), chest_forked_, chest_status_, (expect), #stmt,    \
+                      __FILE__, __LINE__);                                     \
+  } while (0)
+
+#if defined(CHEST_THREAD_SAFE) && CHEST_THREAD_SAFE
+#define CHEST_STRESS(ctx, nthreads, iterations, body)                          \
+  chest_stress((ctx), (nthreads), (iterations), (body), #body, __FILE__,       \
+               __LINE__)
+#else
+/* expands to an undeclared name so the compile error says what is missing */
+#define CHEST_STRESS(ctx, nthreads, iterations, body)                          \
+  CHEST_STRESS_requires_CHEST_THREAD_SAFE
+#endif
+
 #define CHEST_TEST(name) static void name(chest_t *c)
 
 #define CHEST_ADD(c, name) chest_add(c, name, #name)
 
+/* per-TU registrars so tests from many TUs share one runner */
+#define CHEST_GROUP(name)                                                      \
+  void name(chest_t *c);                                                       \
+  void name(chest_t *c)
+#define CHEST_ADD_GROUP(c, name)                                               \
+  do {                                                                         \
+    extern void name(chest_t *);                                               \
+    name(c);                                                                   \
+  } while (0)
+
+#define CHEST_SUITE(c, name, setup, teardown)                                  \
+  chest_add_suite((c), #name, (setup), (teardown))
+#define CHEST_ADD_TO(c, suite, name) chest_add_to(c, #suite, name, #name)
+#define CHEST_FIXTURE(c, type) ((const type *)chest_fixture(c))
+
 #define CHEST_RUN_BEFORE(c, fn) chest_set_before_all((c), (fn))
 #define CHEST_RUN_AFTER(c, fn) chest_set_after_all((c), (fn))
 #define CHEST_RUN_BEFORE_EACH(c, fn) chest_set_before_each((c), (fn))
 #define CHEST_RUN_AFTER_EACH(c, fn) chest_set_after_each((c), (fn))
 
 #define CHEST_RUN_ALL(...)                                                     \
-  int main(void) {                                                             \
+  int main(int argc, char **argv) {                                            \
     chest_t *c = chest_init();                                                 \
     if (c == NULL)                                                             \
       return 1;                                                                \
+    if (chest_parse_args(c, argc, argv) != CHEST_OK) {                         \
+      chest_destroy(c);                                                        \
+      return (int)CHEST_ERR_INTERNAL;                                          \
+    }                                                                          \
     __VA_ARGS__;                                                               \
     chest_error_t res = chest_run(c);                                          \
     chest_summary(c);                                                          \
@@ -207,10 +369,28 @@ extern "C" {
 #define CHEST_PRINT(...) printf(__VA_ARGS__)
 #endif
 
+/* linkage: header-only by default, one out-of-line copy with CHEST_SHARED */
+#if defined(CHEST_IMPLEMENTATION)
+#define CHEST_DEF
+#define CHEST_INTERNAL static
+#elif defined(CHEST_SHARED)
+#define CHEST_DEF extern
+#define CHEST_INTERNAL static
+#else
+#define CHEST_DEF static inline
+#define CHEST_INTERNAL static inline
+#endif
+#if !defined(CHEST_SHARED) || defined(CHEST_IMPLEMENTATION)
+#define CHEST_DEFINE_ALL 1
+#else
+#define CHEST_DEFINE_ALL 0
+#endif
+
 #ifndef CHEST_THREAD_SAFE
 #define CHEST_THREAD_SAFE 0
 #endif
 #if CHEST_THREAD_SAFE
+#include <stdatomic.h>
 #include <threads.h>
 #define CHEST_LOCK(ctx) mtx_lock(&((ctx)->lock))
 #define CHEST_UNLOCK(ctx) mtx_unlock(&((ctx)->lock))
@@ -242,6 +422,34 @@ typedef enum chest_cmp_op_e {
 
 typedef struct chest_ctx_s chest_t;
 typedef void (*testfn_t)(chest_t *c);
+typedef chest_error_t (*setupfn_t)(chest_t *c, void **fixture);
+typedef void (*teardownfn_t)(chest_t *c, void *fixture);
+
+#define CHEST_NO_SUITE SIZE_MAX
+
+/**
+ * Per-test outcome and timing samples collected across repetitions
+ */
+typedef struct chest_stats_s {
+  size_t runs;
+  size_t fails;
+  size_t crashes; /* runs an isolated test was killed by a signal */
+  double lo, hi;  /* fastest and slowest run over all repetitions */
+  double *ms;     /* timings of the last CHEST_REPEAT_SAMPLES runs */
+  size_t ms_cap;
+} chest_stats_t;
+
+/**
+ * Named suite owning a lazily built fixture shared by its tests
+ */
+typedef struct chest_suite_s {
+  char *name;
+  setupfn_t setup;       /* builds the fixture (may be NULL) */
+  teardownfn_t teardown; /* releases the fixture (may be NULL) */
+  void *fixture;
+  bool built;  /* setup has run */
+  bool broken; /* setup reported an error */
+} chest_suite_t;
 
 struct chest_ctx_s {
   testfn_t *tests;
@@ -249,11 +457,35 @@ struct chest_ctx_s {
   size_t *name_lens;
   size_t count;
   size_t cap;
+#if CHEST_THREAD_SAFE
+  atomic_size_t failures; /* bumped from stress threads */
+#else
   size_t failures;
+#endif
   size_t max_name_len;
   char *last_msg;
   bool *results;
+  bool *ran; /* test executed at least once */
   char **messages;
+  size_t *suite_ids; /* owning suite per test or CHEST_NO_SUITE */
+  chest_suite_t *suites;
+  size_t suite_count;
+  size_t suite_cap;
+  size_t current_suite; /* suite of the running test */
+  size_t reg_errors;    /* tests or suites that failed to register */
+  bool update_snapshots; /* rewrite golden files instead of comparing */
+  int *crashes;          /* terminating signal per test, 0 if none */
+  bool isolate;          /* run each test in a forked child */
+  int death_fd;          /* survival pipe inside a death-test child */
+  struct chest_server_s *server; /* fork-server while isolated */
+  size_t repeat;         /* iterations to run, 0 if unbounded */
+  bool until_fail;       /* stop after the first failing iteration */
+  double repeat_secs;    /* wall-clock budget for repetition, 0 if none */
+  size_t iterations;     /* iterations completed */
+  chest_stats_t *stats;  /* per-test stats while repeating, else NULL */
+  jmp_buf *abort_to;     /* landing pad of the running test, else NULL */
+  bool fail_fast;        /* stop the run at the first fatal failure */
+  bool halted;           /* a fatal failure stopped the run */
 #if CHEST_THREAD_SAFE
   mtx_t lock; /* context mutex */
 #endif
@@ -264,6 +496,54 @@ struct chest_ctx_s {
   testfn_t after_each;  /* run after each test */
 };
 
+#if CHEST_THREAD_SAFE
+typedef void (*stressfn_t)(chest_t *c, size_t thread, size_t iter);
+
+/**
+ * Failure reported from a stress thread, linked into a lock-free
+ * multi-producer/single-consumer stack. Nodes come from a per-thread pool
+ * allocated before the threads start.
+ */
+typedef struct chest_fail_node_s {
+  struct chest_fail_node_s *next;
+  size_t thread;
+  char msg[CHEST_STRESS_MSG_SIZE]; /* truncated failure message */
+} chest_fail_node_t;
+
+struct chest_stress_s;
+
+/**
+ * Per-thread state of a CHEST_STRESS run
+ */
+typedef struct chest_stress_thread_s {
+  struct chest_stress_s *run;
+  size_t id;
+  size_t passed; /* iterations without failures */
+  size_t failed; /* iterations with failures */
+  size_t fails;  /* assertion failures, only touched by this thread */
+  double start;  /* wall-clock seconds when released from the barrier */
+  double end;    /* wall-clock seconds after the last iteration */
+  thrd_t thrd;
+  jmp_buf abort_to; /* landing pad for fatal failures on this thread */
+  chest_fail_node_t *pool; /* CHEST_STRESS_MAX_MSGS message nodes */
+  size_t pool_used;
+} chest_stress_thread_t;
+
+/**
+ * Shared state of a CHEST_STRESS run
+ */
+typedef struct chest_stress_s {
+  chest_t *c;
+  stressfn_t fn;
+  size_t nthreads;
+  size_t iterations;
+  atomic_size_t arrived;               /* start barrier */
+  atomic_bool abort;                   /* a thread hit a fatal failure */
+  _Atomic(chest_fail_node_t *) queue;  /* failures, newest first */
+  chest_stress_thread_t *threads;
+} chest_stress_t;
+#endif
+
 #ifndef CHEST_MALLOC
 #define CHEST_MALLOC(size) malloc(size)
 #endif
@@ -274,158 +554,603 @@ struct chest_ctx_s {
 #define CHEST_FREE(ptr) free(ptr)
 #endif
 
-/**
- * chest_init — allocate and initialize test context
- * @return: new context pointer or NULL on allocation failure
- */
-static inline chest_t *chest_init(void) {
-  chest_t *c = (chest_t *)CHEST_MALLOC(sizeof *c);
-  if (c == NULL)
-    return NULL;
-  c->tests = NULL;
-  c->names = NULL;
-  c->name_lens = NULL;
-  c->count = 0;
-  c->cap = 0;
-  c->failures = 0;
-  c->max_name_len = 0;
-  c->last_msg = NULL;
-  c->results = NULL;  // init results array
-  c->messages = NULL; // init messages array
+/* public API, defined below or in the CHEST_IMPLEMENTATION TU */
+CHEST_DEF chest_t *chest_init(void);
+CHEST_DEF void chest_destroy(chest_t *c);
+CHEST_DEF void chest_report(chest_t *c, const char *name, size_t name_len,
+                            int passed, double test_ms, double over_ms,
+                            size_t term_width);
+CHEST_DEF chest_error_t chest_add(chest_t *c, testfn_t fn, const char *name);
+CHEST_DEF chest_error_t chest_add_suite(chest_t *c, const char *name,
+                                        setupfn_t setup, teardownfn_t teardown);
+CHEST_DEF chest_error_t chest_add_to(chest_t *c, const char *suite, testfn_t fn,
+                                     const char *name);
+CHEST_DEF const void *chest_fixture(const chest_t *c);
+CHEST_DEF chest_error_t chest_parse_args(chest_t *c, int argc, char **argv);
+CHEST_DEF chest_error_t chest_run(chest_t *c);
+CHEST_DEF chest_error_t chest_set_before_all(chest_t *c, testfn_t fn);
+CHEST_DEF chest_error_t chest_set_after_all(chest_t *c, testfn_t fn);
+CHEST_DEF chest_error_t chest_set_before_each(chest_t *c, testfn_t fn);
+CHEST_DEF chest_error_t chest_set_after_each(chest_t *c, testfn_t fn);
+CHEST_DEF void chest_summary(chest_t *c);
+CHEST_DEF void chest_fail_msg(chest_t *c, char *msg);
+CHEST_DEF void chest_fail(chest_t *c, const char *fmt, ...);
+CHEST_DEF void chest_abort_test(chest_t *c, chest_error_t res, const char *file,
+                                int line);
+CHEST_DEF chest_error_t chest_snapshot(chest_t *c, const char *path,
+                                       const void *buf, size_t len,
+                                       const char *file, int line);
+CHEST_DEF int chest_death_fork(chest_t *c, int *status);
+CHEST_DEF void chest_death_survived(chest_t *c);
+CHEST_DEF chest_error_t chest_death_check(chest_t *c, int forked, int status,
+                                          int expect, const char *expr,
+                                          const char *file, int line);
 #if CHEST_THREAD_SAFE
-  if (mtx_init(&c->lock, mtx_plain) != thrd_success) {
-    CHEST_FREE(c);
-    return NULL;
-  }
+CHEST_DEF chest_error_t chest_stress(chest_t *c, size_t nthreads,
+                                     size_t iterations, stressfn_t fn,
+                                     const char *expr, const char *file,
+                                     int line);
 #endif
-  /* init hooks */
-  c->before_all = NULL;
-  c->after_all = NULL;
-  c->before_each = NULL;
-  c->after_each = NULL;
-  return c;
-}
+
+/*
+ * Assertion fast paths stay inline in every TU; only the failure path
+ * calls out of line.
+ */
 
 /**
- * chest_destroy — free test context and associated resources
- * @c: context to destroy (NULL safe)
+ * memeq_impl — binary compare any POD object
+ * @c:     non-NULL test context
+ * @A, B:  pointers to objects
+ * @N:     size in bytes
+ * @expr:  textual expression for logging
+ * @file:  source file name
+ * @line:  source line number
  */
-static inline void chest_destroy(chest_t *c) {
+static inline chest_error_t chest_memeq(chest_t *c, const void *A,
+                                        const void *B, size_t N,
+                                        const char *expr, const char *file,
+                                        int line) {
+  chest_error_t result = CHEST_ERR_INTERNAL;
+  bool mismatch = false;
+  size_t i = 0U;
+  size_t w = sizeof(uintptr_t);
+
   if (c != NULL) {
+    const u8 *a = (const u8 *)A;
+    const u8 *b = (const u8 *)B;
 
-    if (c->names) {
-      for (size_t i = 0; i < c->count; ++i) {
-        CHEST_FREE(c->names[i]);
+    for (; (i + w) <= N; i += w) {
+      uintptr_t va = 0U;
+      uintptr_t vb = 0U;
+      (void)memcpy(&va, &a[i], w);
+      (void)memcpy(&vb, &b[i], w);
+      if (va != vb) {
+        mismatch = true;
+        break;
       }
     }
-    CHEST_FREE(c->tests);
-    CHEST_FREE(c->names);
-    CHEST_FREE(c->name_lens);
-    if (c->results)
-      CHEST_FREE(c->results);
-    if (c->messages) { // free messages
-      for (size_t i = 0; i < c->count; ++i)
-        if (c->messages[i])
-          CHEST_FREE(c->messages[i]);
-      CHEST_FREE(c->messages);
+
+    for (; (!mismatch) && (i < N); ++i) {
+      if (a[i] != b[i]) {
+        mismatch = true;
+      }
+    }
+
+    result = mismatch ? CHEST_ERR_ASSERT : CHEST_OK;
+    if (result == CHEST_ERR_ASSERT) {
+      chest_fail(c, "  %s is %s. (%s:%d)\n", expr, CHEST_FALSE_STR, file,
+                 line);
     }
-#if CHEST_THREAD_SAFE
-    mtx_destroy(&c->lock);
-#endif
-    if (c->last_msg)
-      CHEST_FREE(c->last_msg);
-    CHEST_FREE(c);
   }
+
+  return result;
 }
 
 /**
- * chest_report — format and print test result and optional timing
- * @c: test context
- * @name:      display name (no 'test_' prefix; '_' as spaces)
- * @name_len:  length of display name
- * @passed:    non-zero on success, zero on failure
- * @test_ms:   test execution time in ms (if CHEST_MEASURE)
- * @over_ms:   framework overhead in ms (if CHEST_MEASURE)
- * @term_width:terminal columns for flush-right timing
+ * fpeq_impl — float approximate equality
+ * @c:     non-NULL test context
+ * @A, B:  floating-point values
+ * @tol:   tolerance
+ * @expr:  textual expression for logging
+ * @file:  source file name
+ * @line:  source line number
  */
-static inline void chest_report(chest_t *c, const char *name, size_t name_len,
-                                int passed, double test_ms, double over_ms,
-                                size_t term_width) {
-  /* print aligned name and PASS/FAIL */
-  CHEST_PRINT("%-*.*s ... %s%s%s", (int)c->max_name_len, (int)name_len, name,
-              (passed ? CHEST_PASS_COLOR : CHEST_FAIL_COLOR),
-              (passed ? CHEST_PASS_STR : CHEST_FAIL_STR), CHEST_RESET_COLOR);
-  /* print timing if enabled */
-#ifdef CHEST_MEASURE
-  CHEST_PRINT("\t\t%s%.3fms%s + %s%.3fms%s", CHEST_MEASURE_COLOR, test_ms,
-              CHEST_RESET_COLOR, CHEST_MEASURE_COLOR, over_ms,
-              CHEST_RESET_COLOR);
-#endif
-  putc('\n', stdout);
-  /* print assertion message after report */
-  if (!passed && c->last_msg) {
-    CHEST_PRINT("%s", c->last_msg);
-    CHEST_FREE(c->last_msg);
-    c->last_msg = NULL;
+static inline chest_error_t chest_fpeq(chest_t *c, long double A, long double B,
+                                       long double tol, const char *expr,
+                                       const char *file, int line) {
+  chest_error_t result = CHEST_ERR_INTERNAL;
+
+  if (c != NULL) {
+    long double delta = fabsl(A - B);
+    result = (delta <= tol) ? CHEST_OK : CHEST_ERR_ASSERT;
+    if (result == CHEST_ERR_ASSERT) {
+      chest_fail(
+          c, "  %Lg is not within threshold of %Lg (expected %Lg). (%s:%d)\n",
+          A, tol, B, file, line);
+    }
   }
+
+  return result;
 }
 
 /**
- * chest_add — register a test function
- * @c:    test context (non-NULL)
- * @fn:   test function pointer
- * @name: test name string
- * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
+ * streq_impl — C-string null-terminated equality
+ * @c:     non-NULL test context
+ * @A, B:  C-strings
+ * @expr:  textual expression for logging
+ * @file:  source file name
+ * @line:  source line number
  */
-static inline chest_error_t chest_add(chest_t *c, testfn_t fn,
-                                      const char *name) {
-  if (!c || !fn || !name)
-    return CHEST_ERR_INTERNAL;
-  /* grow arrays safely */
-  if (c->count == c->cap) {
-    size_t oldcap = c->cap;
-    if (oldcap > SIZE_MAX / 2)
-      return CHEST_ERR_INTERNAL;
-    size_t newcap = oldcap ? oldcap * 2 : 4;
-    /* Allocate new buffers */
-    testfn_t *nt = CHEST_MALLOC(newcap * sizeof *nt);
-    char **nn = CHEST_MALLOC(newcap * sizeof *nn);
-    size_t *nl = CHEST_MALLOC(newcap * sizeof *nl);
-    bool *nr = CHEST_MALLOC(newcap * sizeof *nr);
-    char **nm = CHEST_MALLOC(newcap * sizeof *nm);
-    if (!nt || !nn || !nl || !nr || !nm) {
-      CHEST_FREE(nt);
-      CHEST_FREE(nn);
-      CHEST_FREE(nl);
-      CHEST_FREE(nr);
-      CHEST_FREE(nm);
-      return CHEST_ERR_INTERNAL;
-    }
-    /* Copy existing entries */
-    if (oldcap) {
-      memcpy(nt, c->tests, oldcap * sizeof *nt);
-      memcpy(nn, c->names, oldcap * sizeof *nn);
-      memcpy(nl, c->name_lens, oldcap * sizeof *nl);
-      memcpy(nr, c->results, oldcap * sizeof *nr);
-      memcpy(nm, c->messages, oldcap * sizeof *nm);
-    }
-    /* init new slots */
-    for (size_t j = oldcap; j < newcap; ++j) {
-      nr[j] = false;
-      nm[j] = NULL;
+static inline chest_error_t chest_streq(chest_t *c, const char *A,
+                                        const char *B, const char *expr,
+                                        const char *file, int line) {
+  chest_error_t result = CHEST_ERR_INTERNAL;
+
+  if ((c != NULL) && (A != NULL) && (B != NULL)) {
+    result = (strcmp(A, B) == 0) ? CHEST_OK : CHEST_ERR_ASSERT;
+    if (result == CHEST_ERR_ASSERT) {
+      chest_fail(c, "  '%s' and '%s' are %s. (%s:%d)\n", A, B, CHEST_DESC_NE,
+                 file, line);
     }
-    /* Free old arrays */
-    CHEST_FREE(c->tests);
-    CHEST_FREE(c->names);
-    CHEST_FREE(c->name_lens);
-    CHEST_FREE(c->results);
-    CHEST_FREE(c->messages);
-    /* Update context */
-    c->tests = nt;
-    c->names = nn;
+  }
+
+  return result;
+}
+
+/**
+ * chest_assert_compare — generic numeric comparison assertion
+ */
+static inline chest_error_t chest_assert_compare(chest_t *c, chest_cmp_op_t op,
+                                                 long double A, long double B,
+                                                 const char *expr,
+                                                 const char *file, int line) {
+  chest_error_t res = CHEST_ERR_INTERNAL;
+  bool ok = false;
+  if (c != NULL) {
+    switch (op) {
+    case CHEST_CMP_LT:
+      ok = (A < B);
+      break;
+    case CHEST_CMP_LE:
+      ok = (A <= B);
+      break;
+    case CHEST_CMP_GT:
+      ok = (A > B);
+      break;
+    case CHEST_CMP_GE:
+      ok = (A >= B);
+      break;
+    case CHEST_CMP_EQ:
+      ok = (A == B);
+      break;
+    case CHEST_CMP_NE:
+      ok = (A != B);
+      break;
+    default:
+      ok = false;
+      break;
+    }
+    res = ok ? CHEST_OK : CHEST_ERR_ASSERT;
+    if (res == CHEST_ERR_ASSERT) {
+      chest_fail(c, "  '%Lg' is not %s '%Lg'. (%s:%d)\n", A, DESC_STR(op), B,
+                 file, line);
+    }
+  }
+  return res;
+}
+
+/**
+ * chest_require — make an assertion fatal to the running test
+ * @c:    test context
+ * @res:  assertion result
+ * @file: source file name
+ * @line: source line number
+ * @return: @res if the test may continue
+ */
+static inline chest_error_t chest_require(chest_t *c, chest_error_t res,
+                                          const char *file, int line) {
+  if (res != CHEST_OK)
+    chest_abort_test(c, res, file, line);
+  return res;
+}
+
+#if CHEST_DEFINE_ALL
+
+/* only the defining TU needs the POSIX headers */
+#if CHEST_HAS_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if CHEST_THREAD_SAFE
+/* stress thread the calling thread belongs to, NULL outside CHEST_STRESS */
+static _Thread_local chest_stress_thread_t *chest_stress_self;
+#endif
+
+/**
+ * chest_vformat — format into a freshly allocated string
+ * @return: string owned by the caller, or NULL on error
+ */
+CHEST_INTERNAL char *chest_vformat(const char *fmt, va_list ap) {
+  va_list cp;
+  va_copy(cp, ap);
+  int n = vsnprintf(NULL, 0, fmt, cp);
+  va_end(cp);
+  if (n < 0)
+    return NULL;
+  char *out = (char *)CHEST_MALLOC((size_t)n + 1);
+  if (out)
+    vsnprintf(out, (size_t)n + 1, fmt, ap);
+  return out;
+}
+
+/**
+ * chest_set_msg — replace the last failure message with formatted text
+ */
+CHEST_INTERNAL void chest_set_msg(chest_t *c, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  char *msg = chest_vformat(fmt, ap);
+  va_end(ap);
+  if (c->last_msg)
+    CHEST_FREE(c->last_msg);
+  c->last_msg = msg;
+}
+
+#if CHEST_THREAD_SAFE
+/**
+ * chest_stress_node — count a failure on a stress thread
+ * @c:    test context
+ * @self: calling stress thread
+ * @return: free node from the thread's pool, or NULL once it is used up
+ */
+CHEST_INTERNAL chest_fail_node_t *
+chest_stress_node(chest_t *c, chest_stress_thread_t *self) {
+  self->fails++;
+  atomic_fetch_add_explicit(&c->failures, 1, memory_order_relaxed);
+  if (self->pool_used == CHEST_STRESS_MAX_MSGS)
+    return NULL;
+  chest_fail_node_t *node = &self->pool[self->pool_used++];
+  node->thread = self->id;
+  return node;
+}
+
+/**
+ * chest_stress_push — publish a filled node on the run's failure stack
+ */
+CHEST_INTERNAL void chest_stress_push(chest_stress_thread_t *self,
+                                      chest_fail_node_t *node) {
+  node->next = atomic_load_explicit(&self->run->queue, memory_order_relaxed);
+  while (!atomic_compare_exchange_weak_explicit(
+      &self->run->queue, &node->next, node, memory_order_release,
+      memory_order_relaxed))
+    ;
+}
+#endif
+
+/**
+ * chest_fail_msg — record an assertion failure
+ * @c:   test context
+ * @msg: heap-allocated message, ownership passes to chest (may be NULL)
+ *
+ * Inside CHEST_STRESS the failure is counted atomically and copied into
+ * a preallocated node on the run's lock-free queue instead of touching
+ * c->last_msg.
+ */
+CHEST_DEF void chest_fail_msg(chest_t *c, char *msg) {
+#if CHEST_THREAD_SAFE
+  chest_stress_thread_t *self = chest_stress_self;
+  if (self) {
+    chest_fail_node_t *node = chest_stress_node(c, self);
+    if (node) {
+      snprintf(node->msg, sizeof node->msg, "%s", msg ? msg : "");
+      chest_stress_push(self, node);
+    }
+    CHEST_FREE(msg);
+    return;
+  }
+#endif
+  c->failures++;
+  if (c->last_msg)
+    CHEST_FREE(c->last_msg);
+  c->last_msg = msg;
+}
+
+/**
+ * chest_fail — record an assertion failure with a formatted message
+ *
+ * On a stress thread the message is formatted straight into a pooled
+ * node, so the failure path allocates nothing and takes no lock.
+ */
+CHEST_DEF void chest_fail(chest_t *c, const char *fmt, ...) {
+  va_list ap;
+#if CHEST_THREAD_SAFE
+  chest_stress_thread_t *self = chest_stress_self;
+  if (self) {
+    chest_fail_node_t *node = chest_stress_node(c, self);
+    if (node) {
+      va_start(ap, fmt);
+      vsnprintf(node->msg, sizeof node->msg, fmt, ap);
+      va_end(ap);
+      chest_stress_push(self, node);
+    }
+    return;
+  }
+#endif
+  va_start(ap, fmt);
+  char *msg = chest_vformat(fmt, ap);
+  va_end(ap);
+  chest_fail_msg(c, msg);
+}
+
+/**
+ * chest_abort_test — end the running test after a fatal failure
+ * @c:    test context
+ * @res:  result of the failed assertion
+ * @file: source file name
+ * @line: source line number
+ *
+ * Jumps back to the runner, which still records the result and runs
+ * after_each. On a stress thread the jump ends that thread, the others
+ * stop after their current iteration and the test ends once all have
+ * joined. Outside a test body (hooks, fixture setup) the failure is
+ * recorded and execution continues. Resources the test acquired before
+ * the jump are not released.
+ */
+CHEST_DEF void chest_abort_test(chest_t *c, chest_error_t res, const char *file,
+                                int line) {
+  if (c == NULL)
+    return;
+  if (res != CHEST_ERR_ASSERT)
+    chest_fail(c, "  required check could not be evaluated. (%s:%d)\n", file,
+               line);
+#if CHEST_THREAD_SAFE
+  chest_stress_thread_t *self = chest_stress_self;
+  if (self)
+    longjmp(self->abort_to, 1);
+#endif
+#if CHEST_HAS_POSIX
+  if (c->death_fd >= 0) {
+    /* inside a death-test child the runner's frames belong to the parent */
+    fflush(NULL);
+    _exit(EXIT_FAILURE);
+  }
+#endif
+  if (c->fail_fast)
+    c->halted = true;
+  if (c->abort_to)
+    longjmp(*c->abort_to, 1);
+}
+
+/**
+ * chest_init — allocate and initialize test context
+ * @return: new context pointer or NULL on allocation failure
+ */
+CHEST_DEF chest_t *chest_init(void) {
+  chest_t *c = (chest_t *)CHEST_MALLOC(sizeof *c);
+  if (c == NULL)
+    return NULL;
+  c->tests = NULL;
+  c->names = NULL;
+  c->name_lens = NULL;
+  c->count = 0;
+  c->cap = 0;
+  c->failures = 0;
+  c->max_name_len = 0;
+  c->last_msg = NULL;
+  c->results = NULL;  // init results array
+  c->ran = NULL;
+  c->messages = NULL; // init messages array
+  c->suite_ids = NULL;
+  c->suites = NULL;
+  c->suite_count = 0;
+  c->suite_cap = 0;
+  c->current_suite = CHEST_NO_SUITE;
+  c->reg_errors = 0;
+  const char *update = getenv(CHEST_SNAPSHOT_ENV);
+  c->update_snapshots = update != NULL && *update != '\0' && *update != '0';
+  c->crashes = NULL;
+  c->isolate = false;
+  c->death_fd = -1;
+  c->server = NULL;
+  c->repeat = 1;
+  c->until_fail = false;
+  c->repeat_secs = 0;
+  c->iterations = 0;
+  c->stats = NULL;
+  c->abort_to = NULL;
+  c->fail_fast = false;
+  c->halted = false;
+#if CHEST_THREAD_SAFE
+  if (mtx_init(&c->lock, mtx_plain) != thrd_success) {
+    CHEST_FREE(c);
+    return NULL;
+  }
+#endif
+  /* init hooks */
+  c->before_all = NULL;
+  c->after_all = NULL;
+  c->before_each = NULL;
+  c->after_each = NULL;
+  return c;
+}
+
+/**
+ * chest_destroy — free test context and associated resources
+ * @c: context to destroy (NULL safe)
+ */
+CHEST_DEF void chest_destroy(chest_t *c) {
+  if (c != NULL) {
+
+    if (c->names) {
+      for (size_t i = 0; i < c->count; ++i) {
+        CHEST_FREE(c->names[i]);
+      }
+    }
+    CHEST_FREE(c->tests);
+    CHEST_FREE(c->names);
+    CHEST_FREE(c->name_lens);
+    if (c->results)
+      CHEST_FREE(c->results);
+    CHEST_FREE(c->ran);
+    if (c->messages) { // free messages
+      for (size_t i = 0; i < c->count; ++i)
+        if (c->messages[i])
+          CHEST_FREE(c->messages[i]);
+      CHEST_FREE(c->messages);
+    }
+    CHEST_FREE(c->suite_ids);
+    CHEST_FREE(c->crashes);
+    if (c->stats) {
+      for (size_t i = 0; i < c->count; ++i)
+        CHEST_FREE(c->stats[i].ms);
+      CHEST_FREE(c->stats);
+    }
+    if (c->suites) {
+      for (size_t i = 0; i < c->suite_count; ++i) {
+        chest_suite_t *s = &c->suites[i];
+        if (s->built && !s->broken && s->teardown)
+          s->teardown(c, s->fixture);
+        CHEST_FREE(s->name);
+      }
+      CHEST_FREE(c->suites);
+    }
+#if CHEST_THREAD_SAFE
+    mtx_destroy(&c->lock);
+#endif
+    if (c->last_msg)
+      CHEST_FREE(c->last_msg);
+    CHEST_FREE(c);
+  }
+}
+
+/**
+ * chest_report_sig — chest_report that also shows CRASH for a test killed
+ * by a signal
+ * @sig: signal that killed an isolated test, zero if none
+ */
+CHEST_INTERNAL void chest_report_sig(chest_t *c, const char *name,
+                                     size_t name_len, int passed, int sig,
+                                     double test_ms, double over_ms,
+                                     size_t term_width) {
+  /* print aligned name and PASS/FAIL/CRASH */
+  CHEST_PRINT("%-*.*s ... %s%s%s", (int)c->max_name_len, (int)name_len, name,
+              (passed ? CHEST_PASS_COLOR : CHEST_FAIL_COLOR),
+              (passed ? CHEST_PASS_STR
+               : sig  ? CHEST_CRASH_STR
+                      : CHEST_FAIL_STR),
+              CHEST_RESET_COLOR);
+  if (sig)
+    CHEST_PRINT(" (signal %d)", sig);
+  /* print timing if enabled */
+#ifdef CHEST_MEASURE
+  CHEST_PRINT("\t\t%s%.3fms%s + %s%.3fms%s", CHEST_MEASURE_COLOR, test_ms,
+              CHEST_RESET_COLOR, CHEST_MEASURE_COLOR, over_ms,
+              CHEST_RESET_COLOR);
+#endif
+  putc('\n', stdout);
+  /* print assertion message after report */
+  if (!passed && c->last_msg) {
+    CHEST_PRINT("%s", c->last_msg);
+    CHEST_FREE(c->last_msg);
+    c->last_msg = NULL;
+  }
+}
+
+/**
+ * chest_report — format and print test result and optional timing
+ * @c: test context
+ * @name:      display name (no 'test_' prefix; '_' as spaces)
+ * @name_len:  length of display name
+ * @passed:    non-zero on success, zero on failure
+ * @test_ms:   test execution time in ms (if CHEST_MEASURE)
+ * @over_ms:   framework overhead in ms (if CHEST_MEASURE)
+ * @term_width:terminal columns for flush-right timing
+ */
+CHEST_DEF void chest_report(chest_t *c, const char *name, size_t name_len,
+                            int passed, double test_ms, double over_ms,
+                            size_t term_width) {
+  chest_report_sig(c, name, name_len, passed, 0, test_ms, over_ms,
+                   term_width);
+}
+
+/**
+ * chest_add — register a test function
+ * @c:    test context (non-NULL)
+ * @fn:   test function pointer
+ * @name: test name string
+ * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
+ */
+CHEST_DEF chest_error_t chest_add(chest_t *c, testfn_t fn, const char *name) {
+  if (!c || !fn || !name)
+    return CHEST_ERR_INTERNAL;
+  /* grow arrays safely */
+  if (c->count == c->cap) {
+    size_t oldcap = c->cap;
+    if (oldcap > SIZE_MAX / 2)
+      return CHEST_ERR_INTERNAL;
+    size_t newcap = oldcap ? oldcap * 2 : 4;
+    /* Allocate new buffers */
+    testfn_t *nt = CHEST_MALLOC(newcap * sizeof *nt);
+    char **nn = CHEST_MALLOC(newcap * sizeof *nn);
+    size_t *nl = CHEST_MALLOC(newcap * sizeof *nl);
+    bool *nr = CHEST_MALLOC(newcap * sizeof *nr);
+    bool *nd = CHEST_MALLOC(newcap * sizeof *nd);
+    char **nm = CHEST_MALLOC(newcap * sizeof *nm);
+    size_t *ns = CHEST_MALLOC(newcap * sizeof *ns);
+    int *nx = CHEST_MALLOC(newcap * sizeof *nx);
+    if (!nt || !nn || !nl || !nr || !nd || !nm || !ns || !nx) {
+      CHEST_FREE(nt);
+      CHEST_FREE(nn);
+      CHEST_FREE(nl);
+      CHEST_FREE(nr);
+      CHEST_FREE(nd);
+      CHEST_FREE(nm);
+      CHEST_FREE(ns);
+      CHEST_FREE(nx);
+      c->reg_errors++;
+      return CHEST_ERR_INTERNAL;
+    }
+    /* Copy existing entries */
+    if (oldcap) {
+      memcpy(nt, c->tests, oldcap * sizeof *nt);
+      memcpy(nn, c->names, oldcap * sizeof *nn);
+      memcpy(nl, c->name_lens, oldcap * sizeof *nl);
+      memcpy(nr, c->results, oldcap * sizeof *nr);
+      memcpy(nd, c->ran, oldcap * sizeof *nd);
+      memcpy(nm, c->messages, oldcap * sizeof *nm);
+      memcpy(ns, c->suite_ids, oldcap * sizeof *ns);
+      memcpy(nx, c->crashes, oldcap * sizeof *nx);
+    }
+    /* init new slots */
+    for (size_t j = oldcap; j < newcap; ++j) {
+      nr[j] = false;
+      nd[j] = false;
+      nm[j] = NULL;
+      nx[j] = 0;
+    }
+    /* Free old arrays */
+    CHEST_FREE(c->tests);
+    CHEST_FREE(c->names);
+    CHEST_FREE(c->name_lens);
+    CHEST_FREE(c->results);
+    CHEST_FREE(c->ran);
+    CHEST_FREE(c->messages);
+    CHEST_FREE(c->suite_ids);
+    CHEST_FREE(c->crashes);
+    /* Update context */
+    c->tests = nt;
+    c->names = nn;
     c->name_lens = nl;
     c->results = nr;
+    c->ran = nd;
     c->messages = nm;
+    c->suite_ids = ns;
+    c->crashes = nx;
     c->cap = newcap;
   }
   /* Prepare display name */
@@ -436,81 +1161,912 @@ static inline chest_error_t chest_add(chest_t *c, testfn_t fn,
   size_t len = strlen(src);
   char *proc = CHEST_MALLOC(len + 1);
   if (!proc) {
+    c->reg_errors++;
+    return CHEST_ERR_INTERNAL;
+  }
+  for (size_t i = 0; i < len; ++i) {
+    proc[i] = (src[i] == '_' ? ' ' : src[i]);
+  }
+  proc[len] = '\0';
+  /* Register test */
+  c->tests[c->count] = fn;
+  c->names[c->count] = proc;
+  c->name_lens[c->count] = len;
+  c->suite_ids[c->count] = CHEST_NO_SUITE;
+  if (len > c->max_name_len) {
+    c->max_name_len = len;
+  }
+  c->count++;
+  return CHEST_OK;
+}
+
+/**
+ * chest_add_suite — register a named suite with fixture hooks
+ * @c:        test context (non-NULL)
+ * @name:     suite name string (must be unique)
+ * @setup:    fixture constructor, run before the suite's first test
+ * @teardown: fixture destructor, run after the suite's last test
+ * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
+ */
+CHEST_DEF chest_error_t chest_add_suite(chest_t *c, const char *name,
+                                        setupfn_t setup,
+                                        teardownfn_t teardown) {
+  if (!c || !name)
+    return CHEST_ERR_INTERNAL;
+  for (size_t i = 0; i < c->suite_count; ++i) {
+    if (strcmp(c->suites[i].name, name) == 0) {
+      fprintf(stderr, "chest: suite '%s' registered twice\n", name);
+      c->reg_errors++;
+      return CHEST_ERR_INTERNAL;
+    }
+  }
+  if (c->suite_count == c->suite_cap) {
+    if (c->suite_cap > SIZE_MAX / 2 / sizeof *c->suites)
+      return CHEST_ERR_INTERNAL;
+    size_t newcap = c->suite_cap ? c->suite_cap * 2 : 4;
+    chest_suite_t *ns =
+        (chest_suite_t *)CHEST_REALLOC(c->suites, newcap * sizeof *ns);
+    if (!ns)
+      return CHEST_ERR_INTERNAL;
+    c->suites = ns;
+    c->suite_cap = newcap;
+  }
+  size_t len = strlen(name);
+  char *copy = (char *)CHEST_MALLOC(len + 1);
+  if (!copy)
+    return CHEST_ERR_INTERNAL;
+  memcpy(copy, name, len + 1);
+  chest_suite_t *s = &c->suites[c->suite_count++];
+  s->name = copy;
+  s->setup = setup;
+  s->teardown = teardown;
+  s->fixture = NULL;
+  s->built = false;
+  s->broken = false;
+  return CHEST_OK;
+}
+
+/**
+ * chest_add_to — register a test function in a named suite
+ * @c:     test context (non-NULL)
+ * @suite: name of a suite registered with chest_add_suite
+ * @fn:    test function pointer
+ * @name:  test name string
+ * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
+ */
+CHEST_DEF chest_error_t chest_add_to(chest_t *c, const char *suite, testfn_t fn,
+                                     const char *name) {
+  if (!c || !suite)
+    return CHEST_ERR_INTERNAL;
+  size_t sid = 0;
+  while (sid < c->suite_count && strcmp(c->suites[sid].name, suite) != 0)
+    ++sid;
+  if (sid == c->suite_count) {
+    /* a dropped test must not look like a passing run */
+    fprintf(stderr, "chest: test '%s' added to unknown suite '%s'\n",
+            name ? name : "?", suite);
+    c->reg_errors++;
+    return CHEST_ERR_INTERNAL;
+  }
+  chest_error_t res = chest_add(c, fn, name);
+  if (res == CHEST_OK)
+    c->suite_ids[c->count - 1] = sid;
+  return res;
+}
+
+/**
+ * chest_fixture — fixture of the currently running test's suite
+ * @c: test context
+ * @return: fixture pointer, or NULL outside of a suite
+ */
+CHEST_DEF const void *chest_fixture(const chest_t *c) {
+  if (!c || c->current_suite == CHEST_NO_SUITE)
+    return NULL;
+  return c->suites[c->current_suite].fixture;
+}
+
+/**
+ * chest_suite_build — run a suite's setup unless it already ran
+ * @c:   test context
+ * @sid: suite index
+ */
+CHEST_INTERNAL void chest_suite_build(chest_t *c, size_t sid) {
+  chest_suite_t *s = &c->suites[sid];
+  if (!s->built) {
+    s->built = true;
+    if (s->setup && s->setup(c, &s->fixture) != CHEST_OK)
+      s->broken = true;
+  }
+}
+
+/**
+ * chest_suite_enter — build a suite's fixture on first use
+ * @c:   test context
+ * @sid: suite index
+ * @return: CHEST_OK if the fixture is usable, CHEST_ERR_ASSERT otherwise
+ */
+CHEST_INTERNAL chest_error_t chest_suite_enter(chest_t *c, size_t sid) {
+  chest_suite_t *s = &c->suites[sid];
+  c->current_suite = sid;
+  chest_suite_build(c, sid);
+  if (!s->broken)
+    return CHEST_OK;
+  chest_fail(c, "  fixture setup for suite '%s' failed.\n", s->name);
+  return CHEST_ERR_ASSERT;
+}
+
+/**
+ * chest_suite_leave — tear down a suite's fixture after its last test
+ * @c:   test context
+ * @sid: suite index
+ */
+CHEST_INTERNAL void chest_suite_leave(chest_t *c, size_t sid) {
+  chest_suite_t *s = &c->suites[sid];
+  if (s->built && !s->broken && s->teardown)
+    s->teardown(c, s->fixture);
+  s->fixture = NULL;
+  s->built = false;
+  s->broken = false;
+  c->current_suite = CHEST_NO_SUITE;
+}
+
+/**
+ * chest_record_result — store and report the outcome of one test
+ * @c:          test context
+ * @idx:        test index
+ * @passed:     true if the test recorded no failures
+ * @sig:        signal that killed an isolated test, zero if none
+ * @test_ms:    test execution time in ms
+ * @mid:        clock() reading taken when the test body returned
+ * @term_width: terminal columns for flush-right timing
+ */
+CHEST_INTERNAL void chest_record_result(chest_t *c, size_t idx, bool passed,
+                                       int sig, double test_ms, clock_t mid,
+                                       size_t term_width) {
+  c->results[idx] = passed; /* record outcome */
+  c->ran[idx] = true;
+  c->crashes[idx] = sig;
+  /* store detailed failure message */
+  if (!passed && c->last_msg) {
+    size_t msglen = strlen(c->last_msg) + 1;
+    char *saved = (char *)CHEST_MALLOC(msglen);
+    if (saved)
+      memcpy(saved, c->last_msg, msglen);
+    if (c->messages[idx])
+      CHEST_FREE(c->messages[idx]);
+    c->messages[idx] = saved;
+  }
+  if (c->stats) {
+    chest_stats_t *st = &c->stats[idx];
+    if (st->runs == st->ms_cap && st->ms_cap < CHEST_REPEAT_SAMPLES) {
+      size_t newcap = st->ms_cap ? st->ms_cap * 2 : 16;
+      if (newcap > CHEST_REPEAT_SAMPLES)
+        newcap = CHEST_REPEAT_SAMPLES;
+      double *nm = (double *)CHEST_REALLOC(st->ms, newcap * sizeof *nm);
+      if (nm) {
+        st->ms = nm;
+        st->ms_cap = newcap;
+      }
+    }
+    /* once full, the buffer is a ring over the most recent runs */
+    if (st->ms_cap)
+      st->ms[st->runs % st->ms_cap] = test_ms;
+    if (st->runs == 0 || test_ms < st->lo)
+      st->lo = test_ms;
+    if (st->runs == 0 || test_ms > st->hi)
+      st->hi = test_ms;
+    st->runs++;
+    st->fails += !passed;
+    st->crashes += sig != 0;
+    if (passed)
+      return; /* only failures are reported while repeating */
+  }
+#ifdef CHEST_MEASURE
+  clock_t end = clock();
+  double over_ms = (double)(end - mid) * 1000.0 / CLOCKS_PER_SEC;
+  chest_report_sig(c, c->names[idx], c->name_lens[idx], passed, sig, test_ms,
+                   over_ms, term_width);
+#else
+  (void)test_ms;
+  (void)mid;
+  chest_report_sig(c, c->names[idx], c->name_lens[idx], passed, sig, 0, 0,
+                   term_width);
+#endif
+}
+
+/**
+ * chest_run_test — execute and report a single registered test
+ * @c:          test context
+ * @idx:        test index
+ * @term_width: terminal columns for flush-right timing
+ */
+CHEST_INTERNAL void chest_run_test(chest_t *c, size_t idx, size_t term_width) {
+  /* track failures before running */
+  size_t baseline = c->failures;
+  bool ready = true;
+  if (c->suite_ids[idx] != CHEST_NO_SUITE)
+    ready = chest_suite_enter(c, c->suite_ids[idx]) == CHEST_OK;
+  if (c->before_each)
+    c->before_each(c);
+  clock_t start = clock();
+  if (ready) {
+    jmp_buf env;
+    c->abort_to = &env;
+    if (setjmp(env) == 0)
+      c->tests[idx](c);
+    c->abort_to = NULL;
+  }
+  clock_t mid = clock();
+  bool passed = (c->failures == baseline);
+  double test_ms = (double)(mid - start) * 1000.0 / CLOCKS_PER_SEC;
+  chest_record_result(c, idx, passed, 0, test_ms, mid, term_width);
+  if (c->after_each)
+    c->after_each(c);
+}
+
+/**
+ * Outcome of one isolated test, written by the child into the ring
+ */
+typedef struct chest_record_s {
+  size_t test;          /* test index */
+  size_t failures;      /* assertion failures recorded by the child */
+  size_t hook_failures; /* failures in after_each, not the test's own */
+  double test_ms;       /* child-side execution time */
+  bool halt;            /* a fatal failure stopped the run (--fail-fast) */
+  char msg[CHEST_RECORD_MSG_SIZE]; /* last failure message, marked if cut */
+} chest_record_t;
+
+/**
+ * Single-producer/single-consumer record ring in shared memory. Children
+ * push, the runner pops. The runner only reads after the fork-server has
+ * reaped the child and reported its status over a pipe, so the kernel
+ * round trip orders the child's stores before the runner's loads.
+ */
+typedef struct chest_ring_s {
+  volatile size_t head; /* next slot to write (children) */
+  volatile size_t tail; /* next slot to read (runner) */
+  chest_record_t slots[CHEST_RING_SLOTS];
+} chest_ring_t;
+
+/**
+ * Fork-server state: the server is forked once after registration and
+ * forks a fresh child per test, so tests never pay exec or static init.
+ */
+typedef struct chest_server_s {
+  long pid;
+  int cmd_fd;    /* runner -> server commands */
+  int status_fd; /* server -> runner wait statuses */
+  chest_ring_t *ring;
+  void (*old_pipe)(int); /* runner's SIGPIPE disposition while serving */
+} chest_server_t;
+
+enum { CHEST_CMD_RUN, CHEST_CMD_LEAVE };
+
+typedef struct chest_cmd_s {
+  int op;
+  size_t arg; /* test index or suite index */
+} chest_cmd_t;
+
+#if CHEST_HAS_POSIX
+/**
+ * chest_io — read or write a whole buffer over a pipe
+ * @return: true if all bytes were transferred
+ */
+CHEST_INTERNAL bool chest_io(int fd, void *buf, size_t len, bool out) {
+  u8 *p = (u8 *)buf;
+  while (len > 0) {
+    ssize_t n = out ? write(fd, p, len) : read(fd, p, len);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    p += n;
+    len -= (size_t)n;
+  }
+  return true;
+}
+
+/**
+ * chest_reap — wait for a child, retrying only when interrupted
+ * @return: true if @status holds the child's wait status
+ */
+CHEST_INTERNAL bool chest_reap(pid_t pid, int *status) {
+  for (;;) {
+    if (waitpid(pid, status, 0) == pid)
+      return true;
+    if (errno != EINTR)
+      return false; /* e.g. ECHILD when SIGCHLD is ignored */
+  }
+}
+
+/**
+ * chest_shared_alloc — map zeroed memory shared with forked children
+ */
+CHEST_INTERNAL void *chest_shared_alloc(size_t size) {
+  void *p = MAP_FAILED;
+#if defined(MAP_ANONYMOUS)
+  p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1,
+           0);
+#elif defined(MAP_ANON)
+  p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANON, -1, 0);
+#else
+  int fd = open("/dev/zero", O_RDWR);
+  if (fd >= 0) {
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+  }
+#endif
+  return p == MAP_FAILED ? NULL : p;
+}
+
+/**
+ * chest_child_exec — run one test inside a forked child and publish the
+ * outcome to the ring; never returns
+ * @baseline: failure count before the server built the test's fixture,
+ *            so setup failures are charged to this test as in-process
+ *
+ * As in-process, the outcome is taken before after_each runs, so hook
+ * failures count against the run but not the test. Two differences
+ * remain: after_each output is printed before the runner's result line,
+ * and after_each does not run for a test that crashed the child.
+ */
+CHEST_INTERNAL void chest_child_exec(chest_t *c, size_t idx,
+                                    chest_ring_t *ring, size_t baseline) {
+  bool ready = true;
+  if (c->suite_ids[idx] != CHEST_NO_SUITE)
+    ready = chest_suite_enter(c, c->suite_ids[idx]) == CHEST_OK;
+  if (c->before_each)
+    c->before_each(c);
+  clock_t start = clock();
+  if (ready) {
+    jmp_buf env;
+    c->abort_to = &env;
+    if (setjmp(env) == 0)
+      c->tests[idx](c);
+    c->abort_to = NULL;
+  }
+  clock_t mid = clock();
+  /* fill the slot now, publish it once after_each has run */
+  size_t head = ring->head;
+  chest_record_t *rec = NULL;
+  if (head - ring->tail < CHEST_RING_SLOTS) {
+    rec = &ring->slots[head % CHEST_RING_SLOTS];
+    rec->test = idx;
+    rec->failures = c->failures - baseline;
+    rec->test_ms = (double)(mid - start) * 1000.0 / CLOCKS_PER_SEC;
+    rec->halt = c->halted;
+    rec->msg[0] = '\0';
+    if (rec->failures && c->last_msg &&
+        snprintf(rec->msg, sizeof rec->msg, "%s", c->last_msg) >=
+            (int)sizeof rec->msg) {
+      static const char mark[] = "\n  ... [truncated]\n";
+      if (sizeof rec->msg >= sizeof mark)
+        memcpy(rec->msg + sizeof rec->msg - sizeof mark, mark, sizeof mark);
+    }
+  }
+  size_t before_hook = c->failures;
+  if (c->after_each)
+    c->after_each(c);
+  if (rec) {
+    rec->hook_failures = c->failures - before_hook;
+    ring->head = head + 1;
+  }
+  fflush(NULL);
+  _exit(0);
+}
+
+/**
+ * chest_server_loop — fork-server main loop; never returns
+ */
+CHEST_INTERNAL void chest_server_loop(chest_t *c, int cmd_fd, int status_fd,
+                                     chest_ring_t *ring) {
+  chest_cmd_t cmd;
+  while (chest_io(cmd_fd, &cmd, sizeof cmd, false)) {
+    if (cmd.op == CHEST_CMD_LEAVE) {
+      int done = 0;
+      chest_suite_leave(c, cmd.arg);
+      fflush(NULL);
+      if (!chest_io(status_fd, &done, sizeof done, true))
+        break;
+      continue;
+    }
+    /* build the fixture here so every child inherits it */
+    size_t baseline = c->failures;
+    if (c->suite_ids[cmd.arg] != CHEST_NO_SUITE)
+      chest_suite_build(c, c->suite_ids[cmd.arg]);
+    fflush(NULL);
+    int status = -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(cmd_fd);
+      close(status_fd);
+      chest_child_exec(c, cmd.arg, ring, baseline);
+    }
+    if (pid > 0 && !chest_reap(pid, &status))
+      status = -1;
+    if (!chest_io(status_fd, &status, sizeof status, true))
+      break;
+  }
+  for (size_t i = 0; i < c->suite_count; ++i)
+    chest_suite_leave(c, i);
+  fflush(NULL);
+  _exit(0);
+}
+#endif
+
+/**
+ * chest_server_start — fork the fork-server for isolated runs
+ * @c: test context with all tests registered
+ * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
+ */
+CHEST_INTERNAL chest_error_t chest_server_start(chest_t *c) {
+#if CHEST_HAS_POSIX
+  chest_server_t *srv = (chest_server_t *)CHEST_MALLOC(sizeof *srv);
+  if (!srv)
+    return CHEST_ERR_INTERNAL;
+  int cmd[2], status[2];
+  srv->ring = (chest_ring_t *)chest_shared_alloc(sizeof *srv->ring);
+  if (!srv->ring) {
+    CHEST_FREE(srv);
+    return CHEST_ERR_INTERNAL;
+  }
+  if (pipe(cmd) != 0) {
+    munmap(srv->ring, sizeof *srv->ring);
+    CHEST_FREE(srv);
+    return CHEST_ERR_INTERNAL;
+  }
+  if (pipe(status) != 0) {
+    close(cmd[0]);
+    close(cmd[1]);
+    munmap(srv->ring, sizeof *srv->ring);
+    CHEST_FREE(srv);
+    return CHEST_ERR_INTERNAL;
+  }
+  fflush(NULL);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(cmd[1]);
+    close(status[0]);
+    chest_server_loop(c, cmd[0], status[1], srv->ring);
+  }
+  close(cmd[0]);
+  close(status[1]);
+  if (pid < 0) {
+    close(cmd[1]);
+    close(status[0]);
+    munmap(srv->ring, sizeof *srv->ring);
+    CHEST_FREE(srv);
+    return CHEST_ERR_INTERNAL;
+  }
+  srv->pid = (long)pid;
+  srv->cmd_fd = cmd[1];
+  srv->status_fd = status[0];
+  /* a dead server must surface as EPIPE, not kill the runner; set after
+   * the fork so tests keep the default disposition */
+  srv->old_pipe = signal(SIGPIPE, SIG_IGN);
+  c->server = srv;
+  return CHEST_OK;
+#else
+  (void)c;
+  return CHEST_ERR_INTERNAL;
+#endif
+}
+
+/**
+ * chest_server_stop — shut down the fork-server and release the ring
+ * @c: test context (NULL safe, no-op without a server)
+ * @return: the server's wait status, or -1 if unknown
+ */
+CHEST_INTERNAL int chest_server_stop(chest_t *c) {
+#if CHEST_HAS_POSIX
+  if (!c || !c->server)
+    return -1;
+  chest_server_t *srv = c->server;
+  close(srv->cmd_fd); /* EOF tells the server to exit */
+  close(srv->status_fd);
+  int status;
+  if (!chest_reap((pid_t)srv->pid, &status))
+    status = -1;
+  if (srv->old_pipe != SIG_ERR)
+    signal(SIGPIPE, srv->old_pipe);
+  munmap(srv->ring, sizeof *srv->ring);
+  CHEST_FREE(srv);
+  c->server = NULL;
+  return status;
+#else
+  (void)c;
+  return -1;
+#endif
+}
+
+/**
+ * chest_server_restart — replace a fork-server that died
+ * @c:      test context with a dead server
+ * @broken: suite whose fixture setup killed it, or CHEST_NO_SUITE
+ * @return: the dead server's wait status, or -1 if unknown
+ *
+ * The broken suite is marked before the new server is forked, so the
+ * server inherits that state and fails the suite's remaining tests
+ * without rerunning the setup. Without a new server the remaining tests
+ * run in-process.
+ */
+CHEST_INTERNAL int chest_server_restart(chest_t *c, size_t broken) {
+  int status = chest_server_stop(c);
+  if (broken != CHEST_NO_SUITE) {
+    c->suites[broken].built = true;
+    c->suites[broken].broken = true;
+  }
+  if (chest_server_start(c) != CHEST_OK)
+    fprintf(stderr, "chest: fork-server unavailable, running in-process\n");
+  return status;
+}
+
+/**
+ * chest_server_leave — have the fork-server tear down a suite's fixture
+ * @c:   test context with a running server
+ * @sid: suite index
+ */
+CHEST_INTERNAL void chest_server_leave(chest_t *c, size_t sid) {
+#if CHEST_HAS_POSIX
+  chest_cmd_t cmd = {CHEST_CMD_LEAVE, sid};
+  int done = -1;
+  fflush(stdout);
+  if (chest_io(c->server->cmd_fd, &cmd, sizeof cmd, true) &&
+      chest_io(c->server->status_fd, &done, sizeof done, false))
+    return;
+  /* the server died in the fixture's teardown; no test owns that */
+  int status = chest_server_restart(c, CHEST_NO_SUITE);
+  c->failures++;
+  if (status != -1 && WIFSIGNALED(status))
+    fprintf(stderr, "chest: teardown of suite '%s' crashed with signal %d\n",
+            c->suites[sid].name, WTERMSIG(status));
+  else
+    fprintf(stderr, "chest: teardown of suite '%s' killed the fork-server\n",
+            c->suites[sid].name);
+#else
+  (void)c;
+  (void)sid;
+#endif
+}
+
+/**
+ * chest_run_isolated — execute one test through the fork-server
+ * @c:          test context with a running server
+ * @idx:        test index
+ * @term_width: terminal columns for flush-right timing
+ */
+CHEST_INTERNAL void chest_run_isolated(chest_t *c, size_t idx,
+                                      size_t term_width) {
+#if CHEST_HAS_POSIX
+  chest_server_t *srv = c->server;
+  chest_cmd_t cmd = {CHEST_CMD_RUN, idx};
+  int status = -1;
+  fflush(stdout); /* keep parent and child output in order */
+  bool ok = chest_io(srv->cmd_fd, &cmd, sizeof cmd, true) &&
+            chest_io(srv->status_fd, &status, sizeof status, false);
+  clock_t mid = clock();
+  double test_ms = 0;
+  bool reported = false;
+  size_t failures = 0;
+  while (srv->ring->tail != srv->ring->head) {
+    chest_record_t *rec =
+        &srv->ring->slots[srv->ring->tail % CHEST_RING_SLOTS];
+    if (rec->test == idx) {
+      reported = true;
+      test_ms = rec->test_ms;
+      failures = rec->failures;
+      c->halted = c->halted || rec->halt;
+      c->failures += rec->hook_failures;
+      if (failures) {
+        c->failures += failures;
+        chest_set_msg(c, "%s", rec->msg);
+      }
+    }
+    srv->ring->tail = srv->ring->tail + 1;
+  }
+  int sig = 0;
+  size_t sid = c->suite_ids[idx];
+  if (!ok) {
+    /* only fixture setup runs inside the server, so for a suite test
+     * that is what killed it */
+    int srv_status = chest_server_restart(c, sid);
+    if (srv_status != -1 && WIFSIGNALED(srv_status))
+      sig = WTERMSIG(srv_status);
+    c->failures++;
+    if (sid != CHEST_NO_SUITE)
+      chest_set_msg(c, "  fixture setup for suite '%s' crashed.\n",
+                    c->suites[sid].name);
+    else
+      chest_set_msg(c, "  fork-server is gone.\n");
+  } else if (status != -1 && WIFSIGNALED(status)) {
+    sig = WTERMSIG(status);
+    c->failures++;
+    chest_set_msg(c, "  test crashed with signal %d.\n", sig);
+  } else if (!reported) {
+    c->failures++;
+    if (status != -1 && WIFEXITED(status))
+      chest_set_msg(c, "  test exited with status %d before finishing.\n",
+                    WEXITSTATUS(status));
+    else
+      chest_set_msg(c, "  test could not be forked or reaped.\n");
+  }
+  bool passed = ok && reported && sig == 0 && failures == 0;
+  chest_record_result(c, idx, passed, sig, test_ms, mid, term_width);
+#else
+  (void)c;
+  (void)idx;
+  (void)term_width;
+#endif
+}
+
+/**
+ * chest_death_fork — fork a child for CHEST_EXPECT_DEATH
+ * @c:      test context
+ * @status: receives the child's wait status in the parent
+ * @return: 0 in the child, 1 if the child survived the statement,
+ *          2 if it died, 3 if it died but could not be reaped,
+ *          -1 if no child could be forked
+ */
+CHEST_DEF int chest_death_fork(chest_t *c, int *status) {
+#if CHEST_HAS_POSIX
+  int fds[2];
+  if (!c || pipe(fds) != 0)
+    return -1;
+  fflush(NULL);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    c->death_fd = fds[1];
+    return 0;
+  }
+  close(fds[1]);
+  if (pid < 0) {
+    close(fds[0]);
+    return -1;
+  }
+  char byte;
+  ssize_t n;
+  do
+    n = read(fds[0], &byte, 1);
+  while (n < 0 && errno == EINTR);
+  close(fds[0]);
+  bool reaped = chest_reap(pid, status);
+  if (n == 1)
+    return 1;
+  return reaped ? 2 : 3;
+#else
+  (void)c;
+  (void)status;
+  return -1;
+#endif
+}
+
+/**
+ * chest_death_survived — report from a death-test child that the
+ * statement returned; never returns
+ */
+CHEST_DEF void chest_death_survived(chest_t *c) {
+#if CHEST_HAS_POSIX
+  char byte = 1;
+  if (write(c->death_fd, &byte, 1) != 1)
+    byte = 0;
+  fflush(NULL);
+  _exit(0);
+#else
+  (void)c;
+  abort();
+#endif
+}
+
+/**
+ * chest_death_check — assert a CHEST_EXPECT_DEATH outcome
+ * @c:      non-NULL test context
+ * @forked: chest_death_fork result
+ * @status: child's wait status
+ * @expect: CHEST_SIGNAL(n), CHEST_EXIT(n) or CHEST_ANY_DEATH
+ * @expr:   textual statement for logging
+ * @file:   source file name
+ * @line:   source line number
+ */
+CHEST_DEF chest_error_t chest_death_check(chest_t *c, int forked, int status,
+                                          int expect, const char *expr,
+                                          const char *file, int line) {
+  if (c == NULL)
     return CHEST_ERR_INTERNAL;
+  if (forked == -1) {
+    chest_fail(c, "  '%s' could not be forked. (%s:%d)\n", expr, file, line);
+    return CHEST_ERR_ASSERT;
   }
-  for (size_t i = 0; i < len; ++i) {
-    proc[i] = (src[i] == '_' ? ' ' : src[i]);
+  if (forked == 1) {
+    chest_fail(c, "  '%s' did not die. (%s:%d)\n", expr, file, line);
+    return CHEST_ERR_ASSERT;
   }
-  proc[len] = '\0';
-  /* Register test */
-  c->tests[c->count] = fn;
-  c->names[c->count] = proc;
-  c->name_lens[c->count] = len;
-  if (len > c->max_name_len) {
-    c->max_name_len = len;
+  if (forked == 3) {
+    if (expect == CHEST_ANY_DEATH)
+      return CHEST_OK;
+    chest_fail(c,
+               "  '%s' died but its status could not be collected. (%s:%d)\n",
+               expr, file, line);
+    return CHEST_ERR_ASSERT;
   }
-  c->count++;
+#if CHEST_HAS_POSIX
+  /* died: CHEST_SIGNAL is negative, CHEST_EXIT non-negative */
+  int got = WIFSIGNALED(status) ? -WTERMSIG(status) : WEXITSTATUS(status);
+  if (expect == CHEST_ANY_DEATH || expect == got)
+    return CHEST_OK;
+  if (got < 0)
+    chest_fail(c, "  '%s' died with signal %d. (%s:%d)\n", expr, -got, file,
+               line);
+  else
+    chest_fail(c, "  '%s' died with exit status %d. (%s:%d)\n", expr, got,
+               file, line);
+#else
+  (void)status;
+  (void)expect;
+#endif
+  return CHEST_ERR_ASSERT;
+}
+
+/**
+ * chest_parse_args — apply command line options to the context
+ * @c:    test context (non-NULL)
+ * @argc: argument count as passed to main
+ * @argv: argument vector as passed to main
+ * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on unknown option
+ */
+CHEST_DEF chest_error_t chest_parse_args(chest_t *c, int argc, char **argv) {
+  if (!c)
+    return CHEST_ERR_INTERNAL;
+  bool repeat_given = false;
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (strcmp(arg, "--update-snapshots") == 0) {
+      c->update_snapshots = true;
+    } else if (strncmp(arg, "--repeat=", 9) == 0) {
+      char *end = NULL;
+      unsigned long long n = strtoull(arg + 9, &end, 10);
+      if (end == arg + 9 || *end != '\0' || n == 0 || n > SIZE_MAX) {
+        fprintf(stderr, "%s: invalid repeat count '%s'\n", argv[0], arg + 9);
+        return CHEST_ERR_INTERNAL;
+      }
+      c->repeat = (size_t)n;
+      repeat_given = true;
+    } else if (strcmp(arg, "--until-fail") == 0) {
+      c->until_fail = true;
+    } else if (strncmp(arg, "--repeat-duration=", 18) == 0) {
+      char *end = NULL;
+      double secs = strtod(arg + 18, &end);
+      if (end == arg + 18 || *end != '\0' || !(secs > 0)) {
+        fprintf(stderr, "%s: invalid repeat duration '%s'\n", argv[0],
+                arg + 18);
+        return CHEST_ERR_INTERNAL;
+      }
+      c->repeat_secs = secs;
+    } else if (strcmp(arg, "--fail-fast") == 0) {
+      c->fail_fast = true;
+    } else if (strcmp(arg, "--isolate") == 0) {
+#if CHEST_HAS_POSIX
+      c->isolate = true;
+#else
+      fprintf(stderr, "%s: --isolate requires POSIX fork()\n", argv[0]);
+      return CHEST_ERR_INTERNAL;
+#endif
+    } else {
+      fprintf(stderr, "%s: unknown option '%s'\n", argv[0], arg);
+      fprintf(stderr,
+              "usage: %s [--update-snapshots] [--isolate] [--repeat=N]\n"
+              "          [--until-fail] [--repeat-duration=SEC]\n"
+              "          [--fail-fast]\n",
+              argv[0]);
+      return CHEST_ERR_INTERNAL;
+    }
+  }
+  /* settled after all options so that their order does not matter: the
+   * other repeat modes lift the default single iteration, while an
+   * explicit count stays a limit alongside them */
+  if (!repeat_given && (c->until_fail || c->repeat_secs > 0))
+    c->repeat = 0;
   return CHEST_OK;
 }
 
+/**
+ * chest_wall_secs — wall-clock time in seconds
+ */
+CHEST_INTERNAL double chest_wall_secs(void) {
+#if CHEST_HAS_POSIX
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#else
+  return (double)time(NULL);
+#endif
+}
+
+/**
+ * chest_repeat_again — decide whether to start another iteration
+ * @c:      test context
+ * @began:  chest_wall_secs() reading before the first iteration
+ * @failed: whether the iteration just finished had failures
+ */
+CHEST_INTERNAL bool chest_repeat_again(const chest_t *c, double began,
+                                      bool failed) {
+  if (!c->stats || c->halted || (c->until_fail && failed))
+    return false;
+  if (c->repeat && c->iterations >= c->repeat)
+    return false;
+  if (c->repeat_secs > 0 && chest_wall_secs() - began >= c->repeat_secs)
+    return false;
+  return true;
+}
+
 /**
  * chest_run — execute all registered tests
  * @c: test context (non-NULL)
- * @return: CHEST_OK if all passed, CHEST_ERR_ASSERT if any failure
+ * @return: CHEST_OK if all passed, CHEST_ERR_ASSERT if any failure,
+ *          CHEST_ERR_INTERNAL if a test or suite failed to register
  */
-static inline chest_error_t chest_run(chest_t *c) {
+CHEST_DEF chest_error_t chest_run(chest_t *c) {
+  if (!c)
+    return CHEST_ERR_INTERNAL;
 #if CHEST_THREAD_SAFE
   CHEST_LOCK(c);
 #endif
-  if (!c)
-    return CHEST_ERR_INTERNAL;
   /* context sanity */
   if (c->count > c->cap || !c->tests || !c->names || !c->results ||
-      !c->messages) {
+      !c->ran || !c->messages || !c->suite_ids) {
+#if CHEST_THREAD_SAFE
+    CHEST_UNLOCK(c);
+#endif
     return CHEST_ERR_INTERNAL;
   }
   const size_t term_width = CHEST_DEFAULT_TERM_WIDTH;
+  bool repeating = c->repeat != 1 || c->until_fail || c->repeat_secs > 0;
+  if (repeating && !c->stats && c->count > 0) {
+    c->stats = (chest_stats_t *)CHEST_MALLOC(c->count * sizeof *c->stats);
+    if (!c->stats) {
+#if CHEST_THREAD_SAFE
+      CHEST_UNLOCK(c);
+#endif
+      return CHEST_ERR_INTERNAL;
+    }
+    memset(c->stats, 0, c->count * sizeof *c->stats);
+  }
   if (c->before_all)
     c->before_all(c);
-  for (size_t idx = 0; idx < c->count; ++idx) {
-    if (c->before_each)
-      c->before_each(c);
-    /* track failures before running */
+  if (c->isolate && chest_server_start(c) != CHEST_OK)
+    fprintf(stderr, "chest: fork-server unavailable, running in-process\n");
+  double began = chest_wall_secs();
+  bool failed;
+  do {
     size_t baseline = c->failures;
-#ifdef CHEST_MEASURE
-    clock_t start = clock();
-#endif
-    c->tests[idx](c);
-#ifdef CHEST_MEASURE
-    clock_t mid = clock();
-#endif
-    bool passed = (c->failures == baseline);
-    c->results[idx] = passed; /* record outcome */
-    /* store detailed failure message */
-    if (!passed && c->last_msg) {
-      size_t msglen = strlen(c->last_msg) + 1;
-      char *saved = (char *)CHEST_MALLOC(msglen);
-      if (saved)
-        memcpy(saved, c->last_msg, msglen);
-      c->messages[idx] = saved;
+    /* ungrouped tests first, then each suite's tests back to back so that
+     * every fixture is built and torn down once per iteration */
+    for (size_t g = 0; g <= c->suite_count && !c->halted; ++g) {
+      size_t sid = (g == 0) ? CHEST_NO_SUITE : g - 1;
+      for (size_t idx = 0; idx < c->count && !c->halted; ++idx) {
+        if (c->suite_ids[idx] != sid)
+          continue;
+        if (c->server)
+          chest_run_isolated(c, idx, term_width);
+        else
+          chest_run_test(c, idx, term_width);
+      }
+      if (sid != CHEST_NO_SUITE && c->server)
+        chest_server_leave(c, sid);
+      if (sid != CHEST_NO_SUITE)
+        chest_suite_leave(c, sid);
     }
-#ifdef CHEST_MEASURE
-    double test_ms = (double)(mid - start) * 1000.0 / CLOCKS_PER_SEC;
-    clock_t end = clock();
-    double over_ms = (double)(end - mid) * 1000.0 / CLOCKS_PER_SEC;
-    chest_report(c, c->names[idx], c->name_lens[idx], passed, test_ms, over_ms,
-                 term_width);
-#else
-    chest_report(c, c->names[idx], c->name_lens[idx], passed, 0, 0, term_width);
-#endif
-    if (c->after_each)
-      c->after_each(c);
-  }
+    c->iterations++;
+    failed = c->failures != baseline;
+  } while (chest_repeat_again(c, began, failed));
+  chest_server_stop(c);
   if (c->after_all)
     c->after_all(c);
 #if CHEST_THREAD_SAFE
   CHEST_UNLOCK(c);
 #endif
+  if (c->reg_errors)
+    return CHEST_ERR_INTERNAL;
   return c->failures ? CHEST_ERR_ASSERT : CHEST_OK;
 }
 
@@ -520,7 +2076,7 @@ static inline chest_error_t chest_run(chest_t *c) {
  * @fn: hook function pointer
  * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
  */
-static inline chest_error_t chest_set_before_all(chest_t *c, testfn_t fn) {
+CHEST_DEF chest_error_t chest_set_before_all(chest_t *c, testfn_t fn) {
   if (!c)
     return CHEST_ERR_INTERNAL;
   c->before_all = fn;
@@ -533,7 +2089,7 @@ static inline chest_error_t chest_set_before_all(chest_t *c, testfn_t fn) {
  * @fn: hook function pointer
  * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
  */
-static inline chest_error_t chest_set_after_all(chest_t *c, testfn_t fn) {
+CHEST_DEF chest_error_t chest_set_after_all(chest_t *c, testfn_t fn) {
   if (!c)
     return CHEST_ERR_INTERNAL;
   c->after_all = fn;
@@ -546,7 +2102,7 @@ static inline chest_error_t chest_set_after_all(chest_t *c, testfn_t fn) {
  * @fn: hook function pointer
  * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
  */
-static inline chest_error_t chest_set_before_each(chest_t *c, testfn_t fn) {
+CHEST_DEF chest_error_t chest_set_before_each(chest_t *c, testfn_t fn) {
   if (!c)
     return CHEST_ERR_INTERNAL;
   c->before_each = fn;
@@ -559,7 +2115,7 @@ static inline chest_error_t chest_set_before_each(chest_t *c, testfn_t fn) {
  * @fn: hook function pointer
  * @return: CHEST_OK on success or CHEST_ERR_INTERNAL on error
  */
-static inline chest_error_t chest_set_after_each(chest_t *c, testfn_t fn) {
+CHEST_DEF chest_error_t chest_set_after_each(chest_t *c, testfn_t fn) {
   if (!c)
     return CHEST_ERR_INTERNAL;
   c->after_each = fn;
@@ -567,192 +2123,696 @@ static inline chest_error_t chest_set_after_each(chest_t *c, testfn_t fn) {
 }
 
 /**
- * memeq_impl — binary compare any POD object
- * @c:     non-NULL test context
- * @A, B:  pointers to objects
- * @N:     size in bytes
- * @expr:  textual expression for logging
- * @file:  source file name
- * @line:  source line number
+ * Growable message buffer used to assemble multi-line failure reports
  */
-static inline chest_error_t chest_memeq(chest_t *c, const void *A,
-                                        const void *B, size_t N,
-                                        const char *expr, const char *file,
-                                        int line) {
-  chest_error_t result = CHEST_ERR_INTERNAL;
-  bool mismatch = false;
-  size_t i = 0U;
-  size_t w = sizeof(uintptr_t);
+typedef struct chest_sbuf_s {
+  char *data;
+  size_t len;
+  size_t cap;
+} chest_sbuf_t;
 
-  if (c != NULL) {
-    const u8 *a = (const u8 *)A;
-    const u8 *b = (const u8 *)B;
+/**
+ * chest_sbuf_printf — append formatted text (silently drops on OOM)
+ */
+CHEST_INTERNAL void chest_sbuf_printf(chest_sbuf_t *b, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(NULL, 0, fmt, ap);
+  va_end(ap);
+  if (n < 0)
+    return;
+  size_t need = b->len + (size_t)n + 1;
+  if (need > b->cap) {
+    size_t newcap = b->cap ? b->cap : 128;
+    while (newcap < need)
+      newcap *= 2;
+    char *nd = (char *)CHEST_REALLOC(b->data, newcap);
+    if (!nd)
+      return;
+    b->data = nd;
+    b->cap = newcap;
+  }
+  va_start(ap, fmt);
+  vsnprintf(b->data + b->len, b->cap - b->len, fmt, ap);
+  va_end(ap);
+  b->len += (size_t)n;
+}
 
-    for (; (i + w) <= N; i += w) {
-      uintptr_t va = 0U;
-      uintptr_t vb = 0U;
-      (void)memcpy(&va, &a[i], w);
-      (void)memcpy(&vb, &b[i], w);
-      if (va != vb) {
-        mismatch = true;
-        break;
+/**
+ * chest_mismatch — offset of the first differing byte
+ * @a, b: buffers
+ * @n:    bytes to compare
+ * @return: offset of the first difference, or n if equal
+ *
+ * Whole blocks are skipped with memcmp, which libc implements with
+ * vector instructions; only the differing block is scanned bytewise.
+ */
+CHEST_INTERNAL size_t chest_mismatch(const u8 *a, const u8 *b, size_t n) {
+  const size_t block = 4096;
+  size_t i = 0;
+  while (i + block <= n && memcmp(a + i, b + i, block) == 0)
+    i += block;
+  while (i < n && a[i] == b[i])
+    ++i;
+  return i;
+}
+
+/**
+ * Line view used by the snapshot text diff
+ */
+typedef struct chest_line_s {
+  const char *p;
+  size_t len;
+  u64 hash;
+  bool eol; /* terminated by '\n' */
+} chest_line_t;
+
+/**
+ * chest_split_lines — split a buffer into hashed lines
+ * @buf, len: text to split
+ * @count:    receives the number of lines
+ * @return: line array owned by the caller, or NULL on OOM / empty input
+ */
+CHEST_INTERNAL chest_line_t *chest_split_lines(const char *buf, size_t len,
+                                              size_t *count) {
+  size_t n = 0;
+  for (const char *p = buf, *end = buf + len; p < end; ++n) {
+    const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+    p = nl ? nl + 1 : end;
+  }
+  *count = n;
+  if (n == 0)
+    return NULL;
+  chest_line_t *lines = (chest_line_t *)CHEST_MALLOC(n * sizeof *lines);
+  if (!lines) {
+    *count = 0;
+    return NULL;
+  }
+  const char *p = buf, *end = buf + len;
+  for (size_t i = 0; i < n; ++i) {
+    const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+    const char *stop = nl ? nl : end;
+    u64 h = 14695981039346656037ULL; /* FNV-1a */
+    for (const char *q = p; q < stop; ++q)
+      h = (h ^ (u8)*q) * 1099511628211ULL;
+    lines[i].p = p;
+    lines[i].len = (size_t)(stop - p);
+    lines[i].hash = h;
+    lines[i].eol = nl != NULL;
+    p = nl ? nl + 1 : end;
+  }
+  return lines;
+}
+
+CHEST_INTERNAL bool chest_line_eq(const chest_line_t *a,
+                                  const chest_line_t *b) {
+  return a->hash == b->hash && a->len == b->len && a->eol == b->eol &&
+         memcmp(a->p, b->p, a->len) == 0;
+}
+
+/**
+ * chest_diff_line — print one diff line, marking a missing final newline
+ */
+CHEST_INTERNAL void chest_diff_line(chest_sbuf_t *out, char op,
+                                    const chest_line_t *l) {
+  chest_sbuf_printf(out, "    %c%.*s\n", op, (int)(l->len > 160 ? 160 : l->len),
+                    l->p);
+  if (!l->eol)
+    chest_sbuf_printf(out, "    \\ No newline at end of file\n");
+}
+
+/**
+ * chest_diff_hex — describe a binary mismatch as a hex window
+ */
+CHEST_INTERNAL void chest_diff_hex(chest_sbuf_t *out, const u8 *exp,
+                                  size_t exp_len, const u8 *act,
+                                  size_t act_len, size_t at) {
+  chest_sbuf_printf(out,
+                    "    first difference at offset 0x%zx "
+                    "(expected %zu bytes, got %zu)\n",
+                    at, exp_len, act_len);
+  size_t row = at / 16;
+  size_t first = row > 0 ? row - 1 : 0;
+  for (size_t r = first; r < first + CHEST_SNAPSHOT_HEX_ROWS; ++r) {
+    size_t off = r * 16;
+    if (off >= exp_len && off >= act_len)
+      break;
+    for (int side = 0; side < 2; ++side) {
+      const u8 *p = side ? act : exp;
+      size_t plen = side ? act_len : exp_len;
+      chest_sbuf_printf(out, "    %c %08zx:", side ? '+' : '-', off);
+      for (size_t j = off; j < off + 16; ++j) {
+        if (j < plen)
+          chest_sbuf_printf(out, " %02x", p[j]);
+        else
+          chest_sbuf_printf(out, "   ");
       }
+      chest_sbuf_printf(out, "\n");
     }
+  }
+}
 
-    for (; (!mismatch) && (i < N); ++i) {
-      if (a[i] != b[i]) {
-        mismatch = true;
+/**
+ * chest_diff_text — describe a text mismatch as a bounded Myers line diff
+ *
+ * Common leading and trailing lines are trimmed first so the O(ND) search
+ * only covers the changed region; the search gives up after
+ * CHEST_SNAPSHOT_MAX_EDITS edits and reports the first differing line.
+ */
+CHEST_INTERNAL void chest_diff_text(chest_sbuf_t *out, const char *exp,
+                                   size_t exp_len, const char *act,
+                                   size_t act_len) {
+  size_t na = 0, nb = 0;
+  chest_line_t *la = chest_split_lines(exp, exp_len, &na);
+  chest_line_t *lb = chest_split_lines(act, act_len, &nb);
+  if ((na && !la) || (nb && !lb)) {
+    CHEST_FREE(la);
+    CHEST_FREE(lb);
+    return;
+  }
+  size_t pre = 0;
+  while (pre < na && pre < nb && chest_line_eq(&la[pre], &lb[pre]))
+    ++pre;
+  size_t suf = 0;
+  while (suf < na - pre && suf < nb - pre &&
+         chest_line_eq(&la[na - 1 - suf], &lb[nb - 1 - suf]))
+    ++suf;
+  size_t first = pre; /* first differing line */
+  /* keep context lines inside the diffed region */
+  pre -= pre < CHEST_SNAPSHOT_CONTEXT ? pre : CHEST_SNAPSHOT_CONTEXT;
+  suf -= suf < CHEST_SNAPSHOT_CONTEXT ? suf : CHEST_SNAPSHOT_CONTEXT;
+  const chest_line_t *a = la + pre, *b = lb + pre;
+  long n = (long)(na - pre - suf), m = (long)(nb - pre - suf);
+  long max = CHEST_SNAPSHOT_MAX_EDITS;
+  if (n + m < max)
+    max = n + m;
+  /* trace[d * d ..] holds V[-d..d] after step d: O(max^2) memory */
+  long *v = (long *)CHEST_MALLOC((size_t)(2 * max + 3) * sizeof *v);
+  long *trace =
+      (long *)CHEST_MALLOC((size_t)(max + 1) * (size_t)(max + 1) * sizeof *v);
+  char *ops = (char *)CHEST_MALLOC((size_t)(n + m + 1));
+  long found = -1;
+  if (v && trace && ops) {
+    v[max + 1] = 0;
+    for (long d = 0; d <= max && found < 0; ++d) {
+      for (long k = -d; k <= d; k += 2) {
+        long x = (k == -d || (k != d && v[max + k - 1] < v[max + k + 1]))
+                     ? v[max + k + 1]
+                     : v[max + k - 1] + 1;
+        long y = x - k;
+        while (x < n && y < m && chest_line_eq(&a[x], &b[y])) {
+          ++x;
+          ++y;
+        }
+        v[max + k] = x;
+        if (x >= n && y >= m)
+          found = d;
       }
+      memcpy(&trace[d * d], &v[max - d], (size_t)(2 * d + 1) * sizeof *v);
     }
-
-    result = mismatch ? CHEST_ERR_ASSERT : CHEST_OK;
-    if (result == CHEST_ERR_ASSERT) {
-      c->failures++;
-      if (c->last_msg)
-        CHEST_FREE(c->last_msg);
-      size_t _len = snprintf(NULL, 0, "  %s is %s. (%s:%d)\n", expr,
-                             CHEST_FALSE_STR, file, line) +
-                    1;
-      c->last_msg = (char *)CHEST_MALLOC(_len);
-      snprintf(c->last_msg, _len, "  %s is %s. (%s:%d)\n", expr,
-               CHEST_FALSE_STR, file, line);
+  }
+  /* no line edits (or over budget): report the first difference only */
+  if (found <= 0) {
+    chest_sbuf_printf(out, "    first difference at line %zu\n", first + 1);
+    if (first < na)
+      chest_diff_line(out, '-', &la[first]);
+    if (first < nb)
+      chest_diff_line(out, '+', &lb[first]);
+  } else {
+    /* walk the trace back from (n, m) to recover the edit script */
+    long x = n, y = m, nops = 0;
+    for (long d = found; d > 0; --d) {
+      const long *pv = &trace[(d - 1) * (d - 1)] + (d - 1); /* pv[k] */
+      long k = x - y;
+      long pk = (k == -d || (k != d && pv[k - 1] < pv[k + 1])) ? k + 1 : k - 1;
+      long px = pv[pk], py = px - pk;
+      while (x > px && y > py) {
+        ops[nops++] = ' ';
+        --x;
+        --y;
+      }
+      if (pk == k + 1) {
+        ops[nops++] = '+';
+        --y;
+      } else {
+        ops[nops++] = '-';
+        --x;
+      }
+    }
+    while (x > 0 && y > 0) {
+      ops[nops++] = ' ';
+      --x;
+      --y;
+    }
+    for (long i = 0, j = nops - 1; i < j; ++i, --j) {
+      char t = ops[i];
+      ops[i] = ops[j];
+      ops[j] = t;
+    }
+    /* print changes with CHEST_SNAPSHOT_CONTEXT common lines around them */
+    const long ctx = CHEST_SNAPSHOT_CONTEXT;
+    long printed = 0, ai = 0, bi = 0, prev = -ctx - 1, next = 0;
+    bool gap = true;
+    for (long i = 0; i < nops; ++i) {
+      if (ops[i] != ' ')
+        prev = i;
+      if (next < i)
+        next = i;
+      while (next < nops && ops[next] == ' ')
+        ++next;
+      bool near = i - prev <= ctx || (next < nops && next - i <= ctx);
+      if (near) {
+        if (printed == CHEST_SNAPSHOT_MAX_LINES) {
+          chest_sbuf_printf(out, "    ...\n");
+          break;
+        }
+        if (gap)
+          chest_sbuf_printf(out, "    @@ -%zu +%zu @@\n", pre + (size_t)ai + 1,
+                            pre + (size_t)bi + 1);
+        chest_diff_line(out, ops[i], (ops[i] == '+') ? &b[bi] : &a[ai]);
+        ++printed;
+      }
+      gap = !near;
+      if (ops[i] != '+')
+        ++ai;
+      if (ops[i] != '-')
+        ++bi;
     }
   }
+  CHEST_FREE(ops);
+  CHEST_FREE(trace);
+  CHEST_FREE(v);
+  CHEST_FREE(la);
+  CHEST_FREE(lb);
+}
 
-  return result;
+/**
+ * chest_snapshot_write — atomically replace a golden file
+ * @path: golden file path
+ * @buf, len: new contents
+ * @return: true on success
+ */
+CHEST_INTERNAL bool chest_snapshot_write(const char *path, const void *buf,
+                                        size_t len) {
+  size_t plen = strlen(path);
+  char *tmp = (char *)CHEST_MALLOC(plen + 32);
+  if (!tmp)
+    return false;
+  bool ok = false;
+#if CHEST_HAS_POSIX
+  snprintf(tmp, plen + 32, "%s.tmp.%ld", path, (long)getpid());
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0) {
+    const u8 *p = (const u8 *)buf;
+    size_t left = len;
+    while (left > 0) {
+      ssize_t w = write(fd, p, left);
+      if (w <= 0)
+        break;
+      p += w;
+      left -= (size_t)w;
+    }
+    ok = left == 0 && fsync(fd) == 0;
+    ok = (close(fd) == 0) && ok;
+  }
+#else
+  snprintf(tmp, plen + 32, "%s.tmp", path);
+  FILE *f = fopen(tmp, "wb");
+  if (f) {
+    ok = fwrite(buf, 1, len, f) == len;
+    ok = (fclose(f) == 0) && ok;
+  }
+  if (ok)
+    remove(path); /* rename does not replace existing files here */
+#endif
+  ok = ok && rename(tmp, path) == 0;
+  if (!ok)
+    remove(tmp);
+  CHEST_FREE(tmp);
+  return ok;
 }
 
 /**
- * fpeq_impl — float approximate equality
+ * chest_snapshot — compare a buffer against a golden file
  * @c:     non-NULL test context
- * @A, B:  floating-point values
- * @tol:   tolerance
- * @expr:  textual expression for logging
+ * @path:  golden file path
+ * @buf:   actual data
+ * @len:   actual data size in bytes
  * @file:  source file name
  * @line:  source line number
+ *
+ * The golden file is memory-mapped where available. In update mode
+ * (CHEST_SNAPSHOT_ENV set or --update-snapshots) a differing or missing
+ * golden is rewritten via a temp file and rename instead of failing.
  */
-static inline chest_error_t chest_fpeq(chest_t *c, long double A, long double B,
-                                       long double tol, const char *expr,
+CHEST_DEF chest_error_t chest_snapshot(chest_t *c, const char *path,
+                                       const void *buf, size_t len,
                                        const char *file, int line) {
-  chest_error_t result = CHEST_ERR_INTERNAL;
-
-  if (c != NULL) {
-    long double delta = fabsl(A - B);
-    result = (delta <= tol) ? CHEST_OK : CHEST_ERR_ASSERT;
-    if (result == CHEST_ERR_ASSERT) {
-      c->failures++;
-      if (c->last_msg)
-        CHEST_FREE(c->last_msg);
-      size_t _len =
-          snprintf(
-              NULL, 0,
-              "  %Lg is not within threshold of %Lg (expected %Lg). (%s:%d)\n",
-              A, tol, B, file, line) +
-          1;
-      c->last_msg = (char *)CHEST_MALLOC(_len);
-      snprintf(c->last_msg, _len,
-               "  %Lg is not within threshold of %Lg (expected %Lg). (%s:%d)\n",
-               A, tol, B, file, line);
+  if (c == NULL)
+    return CHEST_ERR_INTERNAL;
+  /* a NULL buffer usually means the producer under test failed */
+  if (path == NULL || (buf == NULL && len > 0)) {
+    chest_fail(c, "  snapshot %s is NULL. (%s:%d)\n",
+               path == NULL ? "path" : "buffer", file, line);
+    return CHEST_ERR_ASSERT;
+  }
+  const u8 *gold = NULL;
+  size_t gold_len = 0;
+  bool have = false;
+#if CHEST_HAS_POSIX
+  void *map = NULL;
+  int fd = open(path, O_RDONLY);
+  if (fd >= 0) {
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+      have = true;
+      gold_len = (size_t)st.st_size;
+      if (gold_len > 0) {
+        map = mmap(NULL, gold_len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+          map = NULL;
+          have = false;
+        }
+        gold = (const u8 *)map;
+      }
     }
+    close(fd);
   }
+#else
+  u8 *data = NULL;
+  FILE *f = fopen(path, "rb");
+  if (f) {
+    if (fseek(f, 0, SEEK_END) == 0) {
+      long end = ftell(f);
+      if (end >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+        gold_len = (size_t)end;
+        data = (u8 *)CHEST_MALLOC(gold_len ? gold_len : 1);
+        have = data && fread(data, 1, gold_len, f) == gold_len;
+        gold = data;
+      }
+    }
+    fclose(f);
+  }
+#endif
+  const u8 *act = (const u8 *)buf;
+  size_t common = gold_len < len ? gold_len : len;
+  size_t at = have ? chest_mismatch(gold, act, common) : 0;
+  bool match = have && at == common && gold_len == len;
+  bool failed = !match;
+  chest_sbuf_t msg = {NULL, 0, 0};
+  if (!match && c->update_snapshots) {
+    failed = !chest_snapshot_write(path, buf, len);
+    if (failed)
+      chest_sbuf_printf(&msg, "  snapshot '%s' could not be written. (%s:%d)\n",
+                        path, file, line);
+  } else if (!match && !have) {
+    chest_sbuf_printf(&msg,
+                      "  snapshot '%s' is missing (set %s=1 to create it). "
+                      "(%s:%d)\n",
+                      path, CHEST_SNAPSHOT_ENV, file, line);
+  } else if (!match) {
+    chest_sbuf_printf(&msg, "  snapshot '%s' does not match. (%s:%d)\n", path,
+                      file, line);
+    bool binary = (gold_len && memchr(gold, '\0', gold_len)) ||
+                  (len && memchr(act, '\0', len));
+    if (binary)
+      chest_diff_hex(&msg, gold, gold_len, act, len, at);
+    else
+      chest_diff_text(&msg, (const char *)gold, gold_len, (const char *)act,
+                      len);
+  }
+#if CHEST_HAS_POSIX
+  if (map)
+    munmap(map, gold_len);
+#else
+  CHEST_FREE(data);
+#endif
+  if (!failed)
+    return CHEST_OK;
+  chest_fail_msg(c, msg.data);
+  return CHEST_ERR_ASSERT;
+}
 
-  return result;
+#if CHEST_THREAD_SAFE
+/**
+ * chest_stress_main — stress thread entry point
+ */
+CHEST_INTERNAL int chest_stress_main(void *arg) {
+  chest_stress_thread_t *self = (chest_stress_thread_t *)arg;
+  chest_stress_t *run = self->run;
+  chest_stress_self = self;
+  /* spin until every thread has arrived so they all start together */
+  atomic_fetch_add_explicit(&run->arrived, 1, memory_order_acq_rel);
+  for (size_t spins = 0; atomic_load_explicit(&run->arrived,
+                                              memory_order_acquire) <
+                         run->nthreads;
+       ++spins) {
+    if ((spins & 1023) == 1023)
+      thrd_yield();
+  }
+  self->start = chest_wall_secs();
+  if (setjmp(self->abort_to) == 0) {
+    for (size_t it = 0; it < run->iterations; ++it) {
+      if (atomic_load_explicit(&run->abort, memory_order_relaxed))
+        break;
+      size_t before = self->fails;
+      run->fn(run->c, self->id, it);
+      if (self->fails == before)
+        self->passed++;
+      else
+        self->failed++;
+    }
+  } else {
+    /* fatal failure: count the cut-short iteration and stop all threads */
+    self->failed++;
+    atomic_store_explicit(&run->abort, true, memory_order_relaxed);
+  }
+  self->end = chest_wall_secs();
+  chest_stress_self = NULL;
+  return 0;
 }
 
 /**
- * streq_impl — C-string null-terminated equality
- * @c:     non-NULL test context
- * @A, B:  C-strings
- * @expr:  textual expression for logging
- * @file:  source file name
- * @line:  source line number
+ * chest_stress — run a body concurrently from many threads
+ * @c:          non-NULL test context
+ * @nthreads:   number of threads released together from a barrier
+ * @iterations: calls of @fn per thread
+ * @fn:         body, called as fn(c, thread, iteration)
+ * @expr:       textual body for logging
+ * @file:       source file name
+ * @line:       source line number
+ *
+ * Assertions made from @fn are counted with atomics and queued without
+ * locks or allocation, each thread keeping its first CHEST_STRESS_MAX_MSGS
+ * messages in a pool allocated up front. After all threads join,
+ * per-thread pass/fail counts and start / finish skew are printed and
+ * queued messages become the test's message.
  */
-static inline chest_error_t chest_streq(chest_t *c, const char *A,
-                                        const char *B, const char *expr,
-                                        const char *file, int line) {
-  chest_error_t result = CHEST_ERR_INTERNAL;
+CHEST_DEF chest_error_t chest_stress(chest_t *c, size_t nthreads,
+                                     size_t iterations, stressfn_t fn,
+                                     const char *expr, const char *file,
+                                     int line) {
+  if (c == NULL || fn == NULL || nthreads == 0)
+    return CHEST_ERR_INTERNAL;
+  chest_stress_t run;
+  run.c = c;
+  run.fn = fn;
+  run.nthreads = nthreads;
+  run.iterations = iterations;
+  atomic_init(&run.arrived, 0);
+  atomic_init(&run.abort, false);
+  atomic_init(&run.queue, NULL);
+  run.threads = NULL;
+  chest_fail_node_t *pool = NULL;
+  if (nthreads <= SIZE_MAX / sizeof *run.threads &&
+      nthreads <= SIZE_MAX / (CHEST_STRESS_MAX_MSGS * sizeof *pool)) {
+    run.threads = (chest_stress_thread_t *)CHEST_MALLOC(
+        nthreads * sizeof *run.threads);
+    pool = (chest_fail_node_t *)CHEST_MALLOC(nthreads * CHEST_STRESS_MAX_MSGS *
+                                             sizeof *pool);
+  }
+  if (!run.threads || !pool) {
+    CHEST_FREE(run.threads);
+    CHEST_FREE(pool);
+    chest_fail(c, "  stress '%s' could not allocate %zu threads. (%s:%d)\n",
+               expr, nthreads, file, line);
+    return CHEST_ERR_ASSERT;
+  }
+  size_t started = 0;
+  for (; started < nthreads; ++started) {
+    chest_stress_thread_t *t = &run.threads[started];
+    t->run = &run;
+    t->id = started;
+    t->passed = t->failed = t->fails = 0;
+    t->start = t->end = 0;
+    t->pool = pool + started * CHEST_STRESS_MAX_MSGS;
+    t->pool_used = 0;
+    if (thrd_create(&t->thrd, chest_stress_main, t) != thrd_success)
+      break;
+  }
+  if (started < nthreads) {
+    /* release the barrier for threads that did start */
+    atomic_fetch_add(&run.arrived, nthreads - started);
+  }
+  for (size_t i = 0; i < started; ++i)
+    thrd_join(run.threads[i].thrd, NULL);
 
-  if ((c != NULL) && (A != NULL) && (B != NULL)) {
-    result = (strcmp(A, B) == 0) ? CHEST_OK : CHEST_ERR_ASSERT;
-    if (result == CHEST_ERR_ASSERT) {
-      c->failures++;
-      if (c->last_msg)
-        CHEST_FREE(c->last_msg);
-      size_t _len = snprintf(NULL, 0, "  '%s' and '%s' are %s. (%s:%d)\n", A, B,
-                             CHEST_DESC_NE, file, line) +
-                    1;
-      c->last_msg = (char *)CHEST_MALLOC(_len);
-      snprintf(c->last_msg, _len, "  '%s' and '%s' are %s. (%s:%d)\n", A, B,
-               CHEST_DESC_NE, file, line);
+  /* report per-thread counts and how far apart threads started/finished */
+  size_t total = 0;
+  double s_lo = 0, s_hi = 0, e_lo = 0, e_hi = 0;
+  for (size_t i = 0; i < started; ++i) {
+    chest_stress_thread_t *t = &run.threads[i];
+    total += t->fails;
+    if (i == 0 || t->start < s_lo)
+      s_lo = t->start;
+    if (i == 0 || t->start > s_hi)
+      s_hi = t->start;
+    if (i == 0 || t->end < e_lo)
+      e_lo = t->end;
+    if (i == 0 || t->end > e_hi)
+      e_hi = t->end;
+  }
+  CHEST_PRINT("  stress %s: %zu threads x %zu iterations, start skew %.3fms, "
+              "finish skew %.3fms\n",
+              expr, started, iterations, (s_hi - s_lo) * 1000.0,
+              (e_hi - e_lo) * 1000.0);
+  for (size_t i = 0; i < started; ++i) {
+    chest_stress_thread_t *t = &run.threads[i];
+    CHEST_PRINT("    thread %zu: %zu passed, %zu failed\t%s%.3fms%s\n", t->id,
+                t->passed, t->failed, CHEST_MEASURE_COLOR,
+                (t->end - t->start) * 1000.0, CHEST_RESET_COLOR);
+  }
+
+  /* drain the queue; reverse it to report failures oldest first */
+  chest_fail_node_t *node = atomic_exchange(&run.queue, NULL), *rev = NULL;
+  while (node) {
+    chest_fail_node_t *next = node->next;
+    node->next = rev;
+    rev = node;
+    node = next;
+  }
+  chest_sbuf_t msg = {NULL, 0, 0};
+  if (total)
+    chest_sbuf_printf(&msg, "  stress '%s' failed %zu times. (%s:%d)\n", expr,
+                      total, file, line);
+  size_t shown = 0;
+  for (node = rev; node && shown < CHEST_STRESS_MAX_MSGS; node = node->next) {
+    if (node->msg[0] != '\0') {
+      chest_sbuf_printf(&msg, "  [thread %zu]%s", node->thread, node->msg);
+      shown++;
     }
   }
+  CHEST_FREE(pool);
+  CHEST_FREE(run.threads);
+  if (started < nthreads) {
+    CHEST_FREE(msg.data);
+    chest_fail(c, "  stress '%s' started %zu of %zu threads. (%s:%d)\n", expr,
+               started, nthreads, file, line);
+    return CHEST_ERR_ASSERT;
+  }
+  if (!total) {
+    CHEST_FREE(msg.data);
+    return CHEST_OK;
+  }
+  /* failures were already counted by the threads */
+  if (c->last_msg)
+    CHEST_FREE(c->last_msg);
+  c->last_msg = msg.data;
+  if (atomic_load(&run.abort))
+    chest_abort_test(c, CHEST_ERR_ASSERT, file, line);
+  return CHEST_ERR_ASSERT;
+}
+#endif
 
-  return result;
+CHEST_INTERNAL int chest_cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
 }
 
 /**
- * chest_assert_compare — generic numeric comparison assertion
+ * chest_summary_repeat — print per-test failure rates and timing
+ * distribution after a repeated run
  */
-static inline chest_error_t chest_assert_compare(chest_t *c, chest_cmp_op_t op,
-                                                 long double A, long double B,
-                                                 const char *expr,
-                                                 const char *file, int line) {
-  chest_error_t res = CHEST_ERR_INTERNAL;
-  bool ok = false;
-  if (c != NULL) {
-    switch (op) {
-    case CHEST_CMP_LT:
-      ok = (A < B);
-      break;
-    case CHEST_CMP_LE:
-      ok = (A <= B);
-      break;
-    case CHEST_CMP_GT:
-      ok = (A > B);
-      break;
-    case CHEST_CMP_GE:
-      ok = (A >= B);
-      break;
-    case CHEST_CMP_EQ:
-      ok = (A == B);
-      break;
-    case CHEST_CMP_NE:
-      ok = (A != B);
-      break;
-    default:
-      ok = false;
-      break;
+CHEST_INTERNAL void chest_summary_repeat(chest_t *c) {
+  size_t failed = 0, crashed = 0, skipped = 0;
+  CHEST_PRINT("%s\n", CHEST_SEPARATOR);
+  CHEST_PRINT("%zu iterations\n", c->iterations);
+  for (size_t i = 0; i < c->count; ++i) {
+    chest_stats_t *st = &c->stats[i];
+    if (st->runs == 0) {
+      skipped++;
+      CHEST_PRINT("%-*.*s ... %s\n", (int)c->max_name_len,
+                  (int)c->name_lens[i], c->names[i], CHEST_DONE_SKIP);
+      continue;
     }
-    res = ok ? CHEST_OK : CHEST_ERR_ASSERT;
-    if (res == CHEST_ERR_ASSERT) {
-      c->failures++;
-      if (c->last_msg)
-        CHEST_FREE(c->last_msg);
-      const char *desc = DESC_STR(op);
-      size_t _len = snprintf(NULL, 0, "  '%Lg' is not %s '%Lg'. (%s:%d)\n", A,
-                             desc, B, file, line) +
-                    1;
-      c->last_msg = (char *)CHEST_MALLOC(_len);
-      snprintf(c->last_msg, _len, "  '%Lg' is not %s '%Lg'. (%s:%d)\n", A, desc,
-               B, file, line);
+    size_t n = st->runs < st->ms_cap ? st->runs : st->ms_cap;
+    double lo = st->lo, med = 0, hi = st->hi;
+    if (n > 0) {
+      qsort(st->ms, n, sizeof *st->ms, chest_cmp_double);
+      med = (n % 2) ? st->ms[n / 2] : (st->ms[n / 2 - 1] + st->ms[n / 2]) / 2;
+    }
+    double rate = st->runs ? 100.0 * (double)st->fails / (double)st->runs : 0;
+    failed += st->fails != 0;
+    crashed += st->crashes != 0;
+    CHEST_PRINT("%-*.*s ... %s%zu/%zu %s (%.2f%%)", (int)c->max_name_len,
+                (int)c->name_lens[i], c->names[i],
+                (st->fails ? CHEST_FAIL_COLOR : CHEST_PASS_COLOR), st->fails,
+                st->runs, CHEST_DONE_FAIL, rate);
+    if (st->crashes)
+      CHEST_PRINT(", %zu %s", st->crashes, CHEST_DONE_CRASH);
+    CHEST_PRINT("%s", CHEST_RESET_COLOR);
+    CHEST_PRINT("\t%smin %.3fms  median %.3fms  max %.3fms%s\n",
+                CHEST_MEASURE_COLOR, lo, med, hi, CHEST_RESET_COLOR);
+  }
+  CHEST_PRINT("%s\n", CHEST_SEPARATOR);
+  CHEST_PRINT("%zu/%zu %s\n", c->count - failed - skipped, c->count,
+              CHEST_DONE_PASS);
+  CHEST_PRINT("%zu %s\n", failed, CHEST_DONE_FAIL);
+  if (crashed)
+    CHEST_PRINT("%zu %s\n", crashed, CHEST_DONE_CRASH);
+  if (skipped)
+    CHEST_PRINT("%zu %s\n", skipped, CHEST_DONE_SKIP);
+  if (c->reg_errors)
+    CHEST_PRINT("%zu %s\n", c->reg_errors, CHEST_DONE_UNREGISTERED);
+  for (size_t i = 0; i < c->count; ++i) {
+    if (c->stats[i].fails) {
+      CHEST_PRINT("%s\n", c->names[i]);
+      if (c->messages[i])
+        CHEST_PRINT("%s", c->messages[i]);
     }
   }
-  return res;
 }
 
 /**
  * chest_summary — print overall test summary and failed names
  */
-static inline void chest_summary(chest_t *c) {
+CHEST_DEF void chest_summary(chest_t *c) {
   if (!c)
     return;
-  size_t passed = c->count - c->failures;
+  if (c->stats) {
+    chest_summary_repeat(c);
+    return;
+  }
+  /* count tests, not assertions: one test may fail many times */
+  size_t failed = 0, crashed = 0, skipped = 0;
+  for (size_t i = 0; i < c->count; ++i) {
+    skipped += !c->ran[i];
+    failed += c->ran[i] && !c->results[i];
+    crashed += c->crashes[i] != 0;
+  }
   CHEST_PRINT("%s\n", CHEST_SEPARATOR);
-  CHEST_PRINT("%zu/%zu %s\n", passed, c->count, CHEST_DONE_PASS);
-  CHEST_PRINT("%zu %s\n", c->failures, CHEST_DONE_FAIL);
-  if (c->failures) {
+  CHEST_PRINT("%zu/%zu %s\n", c->count - failed - skipped, c->count,
+              CHEST_DONE_PASS);
+  CHEST_PRINT("%zu %s\n", failed, CHEST_DONE_FAIL);
+  if (crashed)
+    CHEST_PRINT("%zu %s\n", crashed, CHEST_DONE_CRASH);
+  if (skipped)
+    CHEST_PRINT("%zu %s\n", skipped, CHEST_DONE_SKIP);
+  if (c->reg_errors)
+    CHEST_PRINT("%zu %s\n", c->reg_errors, CHEST_DONE_UNREGISTERED);
+  if (failed) {
     for (size_t i = 0; i < c->count; ++i) {
-      if (!c->results[i]) {
+      if (c->ran[i] && !c->results[i]) {
         CHEST_PRINT("%s\n", c->names[i]);
         if (c->messages[i])
           CHEST_PRINT("%s", c->messages[i]);
@@ -761,6 +2821,8 @@ static inline void chest_summary(chest_t *c) {
   }
 }
 
+#endif /* CHEST_DEFINE_ALL */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,13 @@
+#include "chest.h"
+
+static void check_index(size_t i, size_t len) {
+  if (i >= len)
+    abort();
+}
+
+CHEST_TEST(death_assertions) {
+  CHEST_EXPECT_DEATH(c, check_index(4, 3), CHEST_SIGNAL(SIGABRT));
+  CHEST_EXPECT_DEATH(c, exit(3), CHEST_EXIT(3));
+}
+
+CHEST_RUN_ALL(CHEST_ADD(c, death_assertions););
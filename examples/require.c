@@ -0,0 +1,29 @@
+#include "chest.h"
+
+typedef struct {
+  int id;
+  const char *name;
+} record_t;
+
+static const record_t records[] = {{1, "alpha"}, {2, "beta"}};
+
+static const record_t *lookup(int id) {
+  for (size_t i = 0; i < sizeof records / sizeof *records; ++i)
+    if (records[i].id == id)
+      return &records[i];
+  return NULL;
+}
+
+CHEST_TEST(lookup_found) {
+  const record_t *r = lookup(2);
+  /* the checks below dereference r, so stop here if it is missing */
+  CHEST_REQUIRE_COMPARE(c, NE, r != NULL, 0);
+  CHEST_STREQ(c, r->name, "beta");
+}
+
+CHEST_TEST(lookup_missing) {
+  const record_t *r = lookup(3);
+  CHEST_COMPARE(c, EQ, r == NULL, 1);
+}
+
+CHEST_RUN_ALL(CHEST_ADD(c, lookup_found); CHEST_ADD(c, lookup_missing););
@@ -0,0 +1,5 @@
+#define CHEST_SHARED
+#define CHEST_IMPLEMENTATION
+#include "chest.h"
+
+CHEST_RUN_ALL(CHEST_ADD_GROUP(c, gcd_tests););
@@ -0,0 +1,13 @@
+#define CHEST_SHARED
+#include "chest.h"
+
+static int gcd(int a, int b) { return b ? gcd(b, a % b) : a; }
+
+CHEST_TEST(gcd_coprime) { CHEST_COMPARE(c, EQ, gcd(9, 28), 1); }
+
+CHEST_TEST(gcd_common) { CHEST_COMPARE(c, EQ, gcd(12, 18), 6); }
+
+CHEST_GROUP(gcd_tests) {
+  CHEST_ADD(c, gcd_coprime);
+  CHEST_ADD(c, gcd_common);
+}
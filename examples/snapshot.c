@@ -0,0 +1,10 @@
+#include "chest.h"
+
+CHEST_TEST(report_snapshot) {
+  char report[256];
+  int len = snprintf(report, sizeof report, "total: %d\nmean: %.2f\n", 42,
+                     3.5);
+  CHEST_SNAPSHOT(c, "snapshot.golden", report, (size_t)len);
+}
+
+CHEST_RUN_ALL(CHEST_ADD(c, report_snapshot););
@@ -0,0 +1,18 @@
+#define CHEST_THREAD_SAFE 1
+#include "chest.h"
+
+static atomic_size_t hits;
+
+static void hit(chest_t *c, size_t thread, size_t iter) {
+  (void)thread;
+  (void)iter;
+  size_t before = atomic_fetch_add(&hits, 1);
+  CHEST_COMPARE(c, LT, before, 4 * 1000);
+}
+
+CHEST_TEST(stress_counter) {
+  CHEST_STRESS(c, 4, 1000, hit);
+  CHEST_COMPARE(c, EQ, atomic_load(&hits), 4 * 1000);
+}
+
+CHEST_RUN_ALL(CHEST_ADD(c, stress_counter););
@@ -0,0 +1,45 @@
+#include "chest.h"
+
+typedef struct {
+  int *values;
+  size_t len;
+} dataset_t;
+
+static chest_error_t dataset_setup(chest_t *c, void **fixture) {
+  (void)c;
+  dataset_t *d = malloc(sizeof *d);
+  if (d == NULL)
+    return CHEST_ERR_INTERNAL;
+  d->len = 1000;
+  d->values = malloc(d->len * sizeof *d->values);
+  if (d->values == NULL) {
+    free(d);
+    return CHEST_ERR_INTERNAL;
+  }
+  for (size_t i = 0; i < d->len; ++i)
+    d->values[i] = (int)i;
+  *fixture = d;
+  return CHEST_OK;
+}
+
+static void dataset_teardown(chest_t *c, void *fixture) {
+  (void)c;
+  dataset_t *d = fixture;
+  free(d->values);
+  free(d);
+}
+
+CHEST_TEST(dataset_length) {
+  const dataset_t *d = CHEST_FIXTURE(c, dataset_t);
+  CHEST_COMPARE(c, EQ, d->len, 1000);
+}
+
+CHEST_TEST(dataset_contents) {
+  const dataset_t *d = CHEST_FIXTURE(c, dataset_t);
+  CHEST_COMPARE(c, EQ, d->values[0], 0);
+  CHEST_COMPARE(c, EQ, d->values[999], 999);
+}
+
+CHEST_RUN_ALL(CHEST_SUITE(c, dataset, dataset_setup, dataset_teardown);
+              CHEST_ADD_TO(c, dataset, dataset_length);
+              CHEST_ADD_TO(c, dataset, dataset_contents););